@@ -1,9 +1,11 @@
 CXX = clang++
 DEPS_BIN = g++
 DEPSFLAGS = -I$(HOME)/.local/include
-CXXFLAGS = -O2 -std=c++11 -I$(HOME)/.local/include
-LDFLAGS = -O2 -L$(HOME)/.local/lib/
-LDLIB = -llexer
+CXXFLAGS = -O2 -std=c++14 -pthread -I$(HOME)/.local/include
+# compile the access and parse time recording hooks in:
+#CXXFLAGS += -DPARAMETER_INSTRUMENTATION
+LDFLAGS = -O2 -pthread -L$(HOME)/.local/lib/
+LDLIB = -llexer -lrt
 AR = ar
 ARFLAGS = rc
 MKDIR = mkdir
@@ -16,18 +18,62 @@ LIB_DIR = lib/
 
 PKG_NAME = parameter
 
-SOURCES = src/main.cpp src/parameter.cpp src/enums.cpp src/collection.cpp
+SOURCES = src/main.cpp src/parameter.cpp src/parser.cpp src/enums.cpp src/collection.cpp \
+          src/validate.cpp src/export.cpp
 
-HEADERS = include/parameter/parameter.hpp
+HEADERS = include/parameter/parameter.hpp include/parameter/instrumentation.hpp \
+          include/parameter/validation.hpp include/parameter/exporter.hpp \
+          include/parameter/table.hpp \
+          include/parameter/completion.hpp \
+          include/parameter/embedded.hpp \
+          include/parameter/lazy.hpp \
+          include/parameter/tracing.hpp \
+          include/parameter/shared.hpp \
+          include/parameter/scope.hpp \
+          include/parameter/adaptive.hpp \
+          include/parameter/fingerprint.hpp \
+          include/parameter/result_store.hpp \
+          include/parameter/prefetch.hpp \
+          include/parameter/view.hpp
 
-BIN = bin/main bin/enums bin/collection
+BIN = bin/main bin/enums bin/collection bin/validate bin/export
 
 
 #bin/...: ...
-bin/main: build/src/main.o build/src/parameter.o
-bin/enums: build/src/enums.o build/src/parameter.o
-bin/collection: build/src/collection.o build/src/parameter.o
+bin/main: build/src/main.o build/src/parameter.o build/src/parser.o
+bin/enums: build/src/enums.o build/src/parameter.o build/src/parser.o
+bin/collection: build/src/collection.o build/src/parameter.o build/src/parser.o
+bin/validate: build/src/validate.o build/src/parameter.o build/src/parser.o
+bin/export: build/src/export.o build/src/parameter.o build/src/parser.o
+
+TEST_SOURCES = test/instrumentation.cpp test/validation.cpp test/exporter.cpp test/dimensions.cpp test/sources.cpp test/tables.cpp test/completion.cpp test/embedded.cpp test/lazy.cpp test/imports.cpp test/tracing.cpp test/shared.cpp test/optional.cpp test/namespaces.cpp test/library.cpp test/adaptive.cpp test/fingerprints.cpp test/ownership.cpp test/prefetch.cpp test/columns.cpp test/views.cpp test/points.cpp test/variants.cpp
+
+TESTS = bin/test-instrumentation bin/test-validation bin/test-exporter bin/test-dimensions bin/test-sources bin/test-tables bin/test-completion bin/test-embedded bin/test-lazy bin/test-imports bin/test-tracing bin/test-shared bin/test-optional bin/test-namespaces bin/test-library bin/test-adaptive bin/test-fingerprints bin/test-ownership bin/test-prefetch bin/test-columns bin/test-views bin/test-points bin/test-variants
+
+bin/test-instrumentation: build/test/instrumentation.o build/src/parameter.o build/src/parser.o
+bin/test-validation: build/test/validation.o build/src/parameter.o build/src/parser.o
+bin/test-exporter: build/test/exporter.o build/src/parameter.o build/src/parser.o
+bin/test-dimensions: build/test/dimensions.o build/src/parameter.o build/src/parser.o
+bin/test-sources: build/test/sources.o build/src/parameter.o build/src/parser.o
+bin/test-tables: build/test/tables.o build/src/parameter.o build/src/parser.o
+bin/test-completion: build/test/completion.o build/src/parameter.o build/src/parser.o
+bin/test-embedded: build/test/embedded.o build/src/parameter.o build/src/parser.o
+bin/test-lazy: build/test/lazy.o build/src/parameter.o build/src/parser.o
+bin/test-imports: build/test/imports.o build/src/parameter.o build/src/parser.o
+bin/test-tracing: build/test/tracing.o build/src/parameter.o build/src/parser.o
+bin/test-shared: build/test/shared.o build/src/parameter.o build/src/parser.o
+bin/test-optional: build/test/optional.o build/src/parameter.o build/src/parser.o
+bin/test-namespaces: build/test/namespaces.o build/src/parameter.o build/src/parser.o
+bin/test-library: build/test/library.o lib/libparameter.a
+bin/test-adaptive: build/test/adaptive.o build/src/parameter.o build/src/parser.o
+bin/test-fingerprints: build/test/fingerprints.o build/src/parameter.o build/src/parser.o
+bin/test-ownership: build/test/ownership.o build/src/parameter.o build/src/parser.o
+bin/test-prefetch: build/test/prefetch.o build/src/parameter.o build/src/parser.o
+bin/test-columns: build/test/columns.o build/src/parameter.o build/src/parser.o
+bin/test-views: build/test/views.o build/src/parameter.o build/src/parser.o
+bin/test-points: build/test/points.o build/src/parameter.o build/src/parser.o
+bin/test-variants: build/test/variants.o build/src/parameter.o build/src/parser.o
 
 LIB = lib/libparameter.a
 
-lib/libparameter.a: build/src/parameter.o
+lib/libparameter.a: build/src/parameter.o build/src/parser.o
@@ -0,0 +1,64 @@
+#!/bin/sh
+#
+# Compile time of a translation unit using the collection, with the
+# headers of a baseline revision and with the headers of the working
+# tree:
+#
+#   scripts/compile-benchmark.sh [baseline-revision [runs]]
+#
+# The compiler and its flags are taken from CXX and CXXFLAGS, which
+# must give access to the lexer and spikes headers for the baseline
+# revisions still including them.
+
+set -e
+
+BASELINE=${1:-HEAD~1}
+RUNS=${2:-10}
+CXX=${CXX:-clang++}
+CXXFLAGS=${CXXFLAGS:-"-O2 -std=c++14 -pthread -I$HOME/.local/include"}
+
+ROOT=$(cd "$(dirname "$0")/.." && pwd)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+mkdir -p "$WORK/baseline"
+git -C "$ROOT" archive "$BASELINE" src | tar -x -C "$WORK/baseline"
+
+cat > "$WORK/user.cpp" <<EOF
+#include "parameter.hpp"
+
+double run(const parameter::collection& c) {
+  return c.get_value<int>("space-subdivisions") * c.get_value<double>("time-step")
+    + c.get_value<std::string>("output-prefix").size();
+}
+EOF
+
+now() {
+  date +%s.%N
+}
+
+measure() {
+  name=$1
+  include=$2
+
+  lines=$($CXX $CXXFLAGS -I"$include" -E "$WORK/user.cpp" | wc -l)
+
+  : > "$WORK/times"
+  i=0
+  while [ $i -lt "$RUNS" ]; do
+    start=$(now)
+    $CXX $CXXFLAGS -I"$include" -c -o "$WORK/$name.o" "$WORK/user.cpp"
+    end=$(now)
+    echo "$start $end" >> "$WORK/times"
+    i=$((i + 1))
+  done
+
+  mean=$(awk '{ total += $2 - $1 } END { print total / NR }' "$WORK/times")
+  size=$(wc -c < "$WORK/$name.o")
+  printf "%-10s %8.3f s %8d preprocessed lines %8d object bytes\n" \
+         "$name" "$mean" "$lines" "$size"
+}
+
+echo "mean of $RUNS compilations with $CXX $CXXFLAGS"
+measure "$BASELINE" "$WORK/baseline/src"
+measure "tree" "$ROOT/src"
@@ -0,0 +1,170 @@
+#ifndef PARAMETER_ADAPTIVE_H
+#define PARAMETER_ADAPTIVE_H
+
+#include <deque>
+#include <string>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * Sweep whose dimensions are refined while it runs, to locate a
+   * transition by bisection instead of sweeping a fine grid:
+   *
+   *   adaptive_sweep sweep(c);
+   *   while (sweep.next()) {
+   *     const std::size_t id(sweep.get_value_id("time-step"));
+   *     stable[id] = run(c);
+   *     ...
+   *     sweep.insert_midpoint("time-step", last_stable_id, first_unstable_id);
+   *   }
+   *
+   * A point is identified by the value id selected in each dimension,
+   * which appending values does not change. The sweep starts with the
+   * points of the collection, and inserting a value only schedules the
+   * points taking the new value, so that a point is never evaluated
+   * twice. The keys must not be redefined while the sweep runs.
+   */
+  class adaptive_sweep {
+  public:
+    adaptive_sweep(collection& c)
+      : c(c), initial_next(0), initial_number(c.get_collection_size()), evaluated_number(0) {}
+
+    /*
+     * Select the next scheduled point in the collection, false when
+     * every point was evaluated.
+     */
+    bool next() {
+      if (initial_next < initial_number) {
+        c.set_current_collection(initial_next);
+        initial_next += 1;
+      } else if (pending.size()) {
+        c.set_current_point(pending.front());
+        pending.pop_front();
+      } else {
+        return false;
+      }
+
+      evaluated_number += 1;
+      return true;
+    }
+
+    /*
+     * Append a value to a key, which must be single valued or alone in
+     * its dimension, and schedule the points taking it. Returns its
+     * value id.
+     */
+    template<typename value_type>
+    std::size_t insert_value(const std::string& key, const value_type& v) {
+      // the points of the collection are renumbered by the insertion
+      schedule_initial_points();
+
+      const std::size_t id(c.append_key_value(key, v));
+      schedule_points(c.get_multi_value(key).get_index_id(), id);
+      return id;
+    }
+
+    std::size_t insert_value(const std::string& key, const char* v) {
+      return insert_value(key, std::string(v));
+    }
+
+    /*
+     * Insert the middle of two values of an integer or real key. For
+     * an integer key, the values must not be consecutive.
+     */
+    std::size_t insert_midpoint(const std::string& key, std::size_t first_id, std::size_t second_id) {
+      const collection::multi_value& mv(c.get_multi_value(key));
+      if (first_id >= mv.get_value_number() or second_id >= mv.get_value_number())
+        throw string_builder("value id out of the ")(mv.get_value_number())
+          (" values of the key '")(key)("'").str();
+
+      const basic_value* first(mv.values[first_id]);
+      const basic_value* second(mv.values[second_id]);
+      const value<int>* first_integer(dynamic_cast<const value<int>*>(first));
+      const value<int>* second_integer(dynamic_cast<const value<int>*>(second));
+      const value<double>* first_real(dynamic_cast<const value<double>*>(first));
+      const value<double>* second_real(dynamic_cast<const value<double>*>(second));
+
+      if (first_integer and second_integer) {
+        const long a(first_integer->get_value()), b(second_integer->get_value());
+        const int middle(static_cast<int>(a + (b - a) / 2));
+        if (middle == a or middle == b)
+          throw string_builder("no integer between the values ")(a)(" and ")(b)
+            (" of the key '")(key)("'").str();
+        return insert_value(key, middle);
+      } else if (first_real and second_real) {
+        return insert_value(key, (first_real->get_value() + second_real->get_value()) / 2.);
+      } else {
+        throw string_builder("cannot insert the middle of values of type ")(first->get_type())
+          (" and ")(second->get_type())(" of the key '")(key)("'").str();
+      }
+    }
+
+    /*
+     * Value id of the key at the current point.
+     */
+    std::size_t get_value_id(const std::string& key) const {
+      const std::size_t id(c.get_multi_value(key).get_index_id());
+      return id == collection::dimension_table::no_dimension ? 0 : c.get_current_point()[id];
+    }
+
+    std::size_t get_evaluated_number() const { return evaluated_number; }
+
+    std::size_t get_pending_number() const {
+      return initial_number - initial_next + pending.size();
+    }
+
+  private:
+    collection& c;
+
+    // points of the collection as it was when the sweep started, which
+    // are only listed in pending once the collection is modified
+    std::size_t initial_next;
+    std::size_t initial_number;
+
+    std::deque<collection::multi_index> pending;
+    std::size_t evaluated_number;
+
+  private:
+    void schedule_initial_points() {
+      if (initial_next == initial_number)
+        return;
+
+      const collection::multi_index current(c.get_current_point());
+      for (; initial_next < initial_number; ++initial_next) {
+        c.set_current_collection(initial_next);
+        pending.push_back(c.get_current_point());
+      }
+      c.set_current_point(current);
+    }
+
+    /*
+     * Every point selecting the value id in the dimension, the other
+     * dimensions taking all their values.
+     */
+    void schedule_points(std::size_t dimension, std::size_t id) {
+      const collection::multi_index& sizes(c.get_dimension_table().get_sizes());
+      collection::multi_index point(sizes.size(), 0);
+      point[dimension] = id;
+
+      while (true) {
+        pending.push_back(point);
+
+        std::size_t d(0);
+        for (; d < sizes.size(); ++d) {
+          if (d == dimension)
+            continue;
+          if (++point[d] < sizes[d])
+            break;
+          point[d] = 0;
+        }
+        if (d == sizes.size())
+          break;
+      }
+    }
+  };
+
+}
+
+#endif /* PARAMETER_ADAPTIVE_H */
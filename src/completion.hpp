@@ -0,0 +1,165 @@
+#ifndef PARAMETER_COMPLETION_H
+#define PARAMETER_COMPLETION_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * On-disk record of the finished points of a sweep, one bit per
+   * collection index. The file is mapped shared and the bits are set
+   * with atomic operations, so that several processes sweeping the
+   * same collection can mark points concurrently. A bit reaches the
+   * page cache as soon as it is set and thus survives a crash of the
+   * process; sync additionally flushes it to the disk.
+   *
+   * The file starts with an 8 bytes magic and the point number, stored
+   * as a 64 bits integer, followed by the bitmap words.
+   */
+  class completion_tracker {
+  public:
+    using word_type = std::uint64_t;
+
+    completion_tracker(const collection& c, const std::string& path)
+      : completion_tracker(c.get_collection_size(), path) {}
+
+    completion_tracker(std::size_t point_number, const std::string& path)
+      : points(point_number), mapping(nullptr), words(nullptr), file_size(0) {
+      const int fd(open(path.c_str(), O_RDWR | O_CREAT, 0644));
+      if (fd == -1)
+        throw std::string("failed to open the completion file '" + path + "': ") + std::strerror(errno);
+
+      // the exclusive lock only serializes the initialization of the file
+      flock(fd, LOCK_EX);
+
+      const std::size_t word_number((points + word_bits - 1) / word_bits);
+      file_size = header_size + word_number * sizeof(word_type);
+
+      struct stat s;
+      fstat(fd, &s);
+      if (s.st_size == 0) {
+        header h;
+        std::memcpy(h.magic, magic, sizeof(h.magic));
+        h.point_number = points;
+        if (ftruncate(fd, file_size) != 0
+            or pwrite(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))) {
+          close(fd);
+          throw std::string("failed to initialize the completion file '" + path + "'");
+        }
+      } else {
+        header h;
+        if (static_cast<std::size_t>(s.st_size) != file_size
+            or pread(fd, &h, sizeof(h), 0) != static_cast<ssize_t>(sizeof(h))
+            or std::memcmp(h.magic, magic, sizeof(h.magic)) != 0
+            or h.point_number != points) {
+          close(fd);
+          throw string_builder("the completion file '")(path)
+            ("' does not record a sweep of ")(points)(" points").str();
+        }
+      }
+
+      void* address(mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+      flock(fd, LOCK_UN);
+      close(fd);
+
+      if (address == MAP_FAILED)
+        throw std::string("failed to map the completion file '" + path + "': ") + std::strerror(errno);
+
+      mapping = address;
+      words = reinterpret_cast<word_type*>(static_cast<char*>(address) + header_size);
+    }
+
+    ~completion_tracker() {
+      if (mapping)
+        munmap(mapping, file_size);
+    }
+
+    completion_tracker(const completion_tracker&) = delete;
+    completion_tracker& operator=(const completion_tracker&) = delete;
+
+    std::size_t get_point_number() const { return points; }
+
+    /*
+     * Returns false if the point was already marked.
+     */
+    bool mark_done(std::size_t i) {
+      check_index(i);
+      const word_type bit(word_type(1) << (i % word_bits));
+      return not (__atomic_fetch_or(words + i / word_bits, bit, __ATOMIC_RELEASE) & bit);
+    }
+
+    bool is_done(std::size_t i) const {
+      check_index(i);
+      return __atomic_load_n(words + i / word_bits, __ATOMIC_ACQUIRE) & (word_type(1) << (i % word_bits));
+    }
+
+    /*
+     * First unfinished index not smaller than from, or
+     * get_point_number() when every remaining point is done.
+     */
+    std::size_t next_unfinished(std::size_t from = 0) const {
+      if (from >= points)
+        return points;
+
+      std::size_t w(from / word_bits);
+      word_type pending(~__atomic_load_n(words + w, __ATOMIC_ACQUIRE) & (~word_type(0) << (from % word_bits)));
+      const std::size_t word_number((points + word_bits - 1) / word_bits);
+      while (not pending and ++w < word_number)
+        pending = ~__atomic_load_n(words + w, __ATOMIC_ACQUIRE);
+
+      if (not pending)
+        return points;
+
+      return std::min(points, w * word_bits + __builtin_ctzll(pending));
+    }
+
+    std::size_t count_done() const {
+      std::size_t n(0);
+      const std::size_t word_number((points + word_bits - 1) / word_bits);
+      for (std::size_t w(0); w < word_number; ++w)
+        n += __builtin_popcountll(__atomic_load_n(words + w, __ATOMIC_RELAXED));
+      return n;
+    }
+
+    void sync() const {
+      if (msync(mapping, file_size, MS_SYNC) != 0)
+        throw std::string("failed to sync the completion file: ") + std::strerror(errno);
+    }
+
+  private:
+    struct header {
+      char magic[8];
+      std::uint64_t point_number;
+    };
+
+    static constexpr std::size_t word_bits = 8 * sizeof(word_type);
+    static constexpr std::size_t header_size = sizeof(header);
+    static constexpr const char* magic = "PRMDONE1";
+
+    std::size_t points;
+    void* mapping;
+    word_type* words;
+    std::size_t file_size;
+
+  private:
+    void check_index(std::size_t i) const {
+      if (i >= points)
+        throw string_builder("sweep index ")(i)(" is out of range, the sweep has ")
+          (points)(" points").str();
+    }
+  };
+
+}
+
+#endif /* PARAMETER_COMPLETION_H */
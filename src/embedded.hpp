@@ -0,0 +1,439 @@
+#ifndef PARAMETER_EMBEDDED_H
+#define PARAMETER_EMBEDDED_H
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * A view on characters of an embedded parameter text.
+   */
+  struct embedded_string {
+    const char* data;
+    std::size_t size;
+
+    constexpr embedded_string(): data(nullptr), size(0) {}
+    constexpr embedded_string(const char* data, std::size_t size): data(data), size(size) {}
+
+    constexpr bool operator==(const char* s) const {
+      std::size_t i(0);
+      for (; i < size; ++i)
+        if (s[i] != data[i])
+          return false;
+      return s[i] == '\0';
+    }
+
+    constexpr bool operator==(const embedded_string& s) const {
+      if (s.size != size)
+        return false;
+      for (std::size_t i(0); i < size; ++i)
+        if (s.data[i] != data[i])
+          return false;
+      return true;
+    }
+
+    std::string to_string() const { return std::string(data, size); }
+  };
+
+  struct embedded_entry {
+    enum class kind { integer, real, boolean, string, enum_item };
+
+    embedded_string key;
+    kind k;
+    embedded_string text;
+    int integer;
+    double real;
+    bool boolean;
+
+    constexpr embedded_entry(): key(), k(kind::integer), text(), integer(0), real(0.), boolean(false) {}
+  };
+
+  namespace detail {
+
+    constexpr bool is_key_character(char c) {
+      return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9')
+        or c == '-' or c == '_';
+    }
+
+    constexpr bool is_digit(char c) { return c >= '0' and c <= '9'; }
+
+    constexpr bool is_space(char c) {
+      return c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\v' or c == '\f';
+    }
+
+    constexpr std::size_t skip_blanks(const char* text, std::size_t i) {
+      while (true) {
+        if (is_space(text[i]))
+          i += 1;
+        else if (text[i] == ';')
+          while (text[i] != '\0' and text[i] != '\n')
+            i += 1;
+        else
+          return i;
+      }
+    }
+
+    constexpr bool is_integer_literal(embedded_string s) {
+      std::size_t i(s.size and (s.data[0] == '+' or s.data[0] == '-') ? 1 : 0);
+      if (i == s.size)
+        return false;
+      for (; i < s.size; ++i)
+        if (not is_digit(s.data[i]))
+          return false;
+      return true;
+    }
+
+    // [+-]?((\.\d+)|(\d+\.)|(\d+\.\d+)|(\d+))([eE][+-]?\d+)?
+    constexpr bool is_real_literal(embedded_string s) {
+      std::size_t i(s.size and (s.data[0] == '+' or s.data[0] == '-') ? 1 : 0);
+      std::size_t digits(0);
+      while (i < s.size and is_digit(s.data[i])) { i += 1; digits += 1; }
+      if (i < s.size and s.data[i] == '.') {
+        i += 1;
+        while (i < s.size and is_digit(s.data[i])) { i += 1; digits += 1; }
+      }
+      if (digits == 0)
+        return false;
+      if (i < s.size and (s.data[i] == 'e' or s.data[i] == 'E')) {
+        i += 1;
+        if (i < s.size and (s.data[i] == '+' or s.data[i] == '-'))
+          i += 1;
+        if (i == s.size)
+          return false;
+        while (i < s.size and is_digit(s.data[i]))
+          i += 1;
+      }
+      return i == s.size;
+    }
+
+    constexpr int boolean_literal(embedded_string s) {
+      if (s == "true" or s == "yes" or s == "on")
+        return 1;
+      if (s == "false" or s == "no" or s == "off")
+        return 0;
+      return -1;
+    }
+
+    constexpr int to_integer(embedded_string s) {
+      const bool negative(s.data[0] == '-');
+      long long v(0);
+      for (std::size_t i(s.data[0] == '+' or negative ? 1 : 0); i < s.size; ++i) {
+        v = 10 * v + (s.data[i] - '0');
+        if (v > static_cast<long long>(std::numeric_limits<int>::max()) + 1)
+          throw std::string("integer literal out of range in embedded parameters");
+      }
+      if (not negative and v > std::numeric_limits<int>::max())
+        throw std::string("integer literal out of range in embedded parameters");
+      return static_cast<int>(negative ? -v : v);
+    }
+
+    /*
+     * Literals with at most 15 significant digits and a decimal
+     * exponent of at most 22 in magnitude are converted exactly, as
+     * strtod would. Beyond that, the result may differ from the
+     * runtime parser by a few units in the last place.
+     */
+    constexpr double to_real(embedded_string s) {
+      std::size_t i(0);
+      const bool negative(s.data[0] == '-');
+      if (s.data[0] == '+' or negative)
+        i += 1;
+
+      std::uint64_t mantissa(0);
+      int exponent(0), significant_digits(0);
+      bool after_point(false);
+      for (; i < s.size and s.data[i] != 'e' and s.data[i] != 'E'; ++i) {
+        if (s.data[i] == '.') {
+          after_point = true;
+          continue;
+        }
+        if (significant_digits < 19) {
+          mantissa = 10 * mantissa + (s.data[i] - '0');
+          if (mantissa)
+            significant_digits += 1;
+          exponent -= after_point ? 1 : 0;
+        } else {
+          exponent += after_point ? 0 : 1;
+        }
+      }
+
+      if (i < s.size) {
+        i += 1;
+        const bool negative_exponent(s.data[i] == '-');
+        if (s.data[i] == '+' or negative_exponent)
+          i += 1;
+        int e(0);
+        for (; i < s.size; ++i)
+          e = e < 10000 ? 10 * e + (s.data[i] - '0') : e;
+        exponent += negative_exponent ? -e : e;
+      }
+
+      double scale(1.);
+      for (int k(0); k < (exponent < 0 ? -exponent : exponent) and k < 400; ++k)
+        scale *= 10.;
+
+      const double v(exponent < 0 ? mantissa / scale : mantissa * scale);
+      return negative ? -v : v;
+    }
+
+    template<std::size_t size>
+    struct embedded_parser {
+      embedded_entry entries[size ? size : 1];
+      std::size_t entry_number;
+
+      constexpr embedded_parser(const char* text, bool count_only)
+        : entries(), entry_number(0) {
+        std::size_t i(skip_blanks(text, 0));
+        while (text[i] != '\0') {
+          embedded_entry e;
+
+          if (text[i] == '[')
+            throw std::string("groups are not supported in embedded parameters");
+
+          const std::size_t key_begin(i);
+          while (is_key_character(text[i])
+                 or (text[i] == '.' and i > key_begin and is_key_character(text[i + 1])))
+            i += 1;
+          if (i == key_begin)
+            throw std::string("unexpected character in embedded parameters, a key was expected");
+          e.key = embedded_string(text + key_begin, i - key_begin);
+          if (e.key == "import" or e.key == "override")
+            throw std::string("import and override are not supported in embedded parameters");
+
+          i = skip_blanks(text, i);
+          if (text[i] == '=' or text[i] == ':')
+            i += 1;
+          else if (text[i] == '-' and text[i + 1] == '>')
+            i += 2;
+          else
+            throw std::string("missing definition symbol after a key in embedded parameters");
+
+          i = skip_blanks(text, i);
+          const std::size_t value_begin(i);
+          if (text[i] == '"') {
+            i += 1;
+            while (text[i] != '"') {
+              if (text[i] == '\0')
+                throw std::string("unterminated string in embedded parameters");
+              if (text[i] == '\\' and (text[i + 1] == '"' or text[i + 1] == '\\'))
+                i += 1;
+              i += 1;
+            }
+            i += 1;
+            e.k = embedded_entry::kind::string;
+            e.text = embedded_string(text + value_begin + 1, i - value_begin - 2);
+          } else if (text[i] == '#') {
+            i += 1;
+            while (is_key_character(text[i]))
+              i += 1;
+            e.k = embedded_entry::kind::enum_item;
+            e.text = embedded_string(text + value_begin + 1, i - value_begin - 1);
+          } else {
+            while (is_key_character(text[i]) or text[i] == '.' or text[i] == '+')
+              i += 1;
+            e.text = embedded_string(text + value_begin, i - value_begin);
+            if (is_integer_literal(e.text)) {
+              e.k = embedded_entry::kind::integer;
+              e.integer = to_integer(e.text);
+            } else if (is_real_literal(e.text)) {
+              e.k = embedded_entry::kind::real;
+              e.real = to_real(e.text);
+            } else if (boolean_literal(e.text) >= 0) {
+              e.k = embedded_entry::kind::boolean;
+              e.boolean = boolean_literal(e.text) == 1;
+            } else if (e.text.size) {
+              throw std::string("references to other keys are not supported in embedded parameters");
+            } else {
+              throw std::string("missing value in embedded parameters");
+            }
+          }
+
+          i = skip_blanks(text, i);
+          if (text[i] == ',')
+            throw std::string("value lists are not supported in embedded parameters");
+
+          if (not count_only) {
+            for (std::size_t k(0); k < entry_number; ++k)
+              if (entries[k].key == e.key)
+                throw std::string("duplicate key in embedded parameters");
+            entries[entry_number] = e;
+          }
+          entry_number += 1;
+        }
+      }
+    };
+
+    template<typename value_type>
+    struct embedded_value;
+
+    template<>
+    struct embedded_value<int> {
+      static constexpr embedded_entry::kind k = embedded_entry::kind::integer;
+      static constexpr int extract(const embedded_entry& e) { return e.integer; }
+    };
+
+    template<>
+    struct embedded_value<double> {
+      static constexpr embedded_entry::kind k = embedded_entry::kind::real;
+      static constexpr double extract(const embedded_entry& e) { return e.real; }
+    };
+
+    template<>
+    struct embedded_value<bool> {
+      static constexpr embedded_entry::kind k = embedded_entry::kind::boolean;
+      static constexpr bool extract(const embedded_entry& e) { return e.boolean; }
+    };
+
+    template<>
+    struct embedded_value<embedded_string> {
+      static constexpr embedded_entry::kind k = embedded_entry::kind::string;
+      static constexpr embedded_string extract(const embedded_entry& e) {
+        // the view is only exact when there is nothing to unescape or interpolate
+        for (std::size_t i(0); i < e.text.size; ++i)
+          if (e.text.data[i] == '\\' or e.text.data[i] == '{')
+            throw std::string("escaped or interpolated strings can only be read from a collection");
+        return e.text;
+      }
+    };
+
+  }
+
+  /*
+   * Parameters parsed at compile time from an embedded text, typically
+   * a raw string literal holding default values:
+   *
+   *   constexpr const char defaults_text[] = R"(
+   *     space-subdivisions = 100
+   *     final-time = 1.5
+   *     left-bc-type = #dirichlet
+   *   )";
+   *   constexpr auto defaults(parameter::make_embedded_parameters<
+   *     parameter::count_embedded_parameters(defaults_text)>(defaults_text));
+   *
+   *   constexpr int n(defaults.get<int>("space-subdivisions"));
+   *
+   * Only single valued definitions are supported. When evaluated in a
+   * constant expression, a syntax error, a missing key or a type
+   * mismatch is a compile error. get always returns the embedded
+   * value: to honour the values given at runtime, install the defaults
+   * in a collection before reading the files, which may then redefine
+   * them with 'override', and read the values from the collection.
+   */
+  template<std::size_t size>
+  class embedded_parameters {
+  public:
+    constexpr explicit embedded_parameters(const char* text): parser(text, false) {}
+
+    constexpr std::size_t get_size() const { return parser.entry_number; }
+    constexpr const embedded_entry& get_entry(std::size_t i) const { return parser.entries[i]; }
+
+    constexpr bool contains(const char* key) const {
+      for (std::size_t i(0); i < size; ++i)
+        if (parser.entries[i].key == key)
+          return true;
+      return false;
+    }
+
+    template<typename value_type>
+    constexpr value_type get(const char* key) const {
+      return detail::embedded_value<value_type>::extract(find(key, detail::embedded_value<value_type>::k));
+    }
+
+    template<typename enum_type, std::size_t item_number>
+    constexpr enum_type get_enum(const char* key,
+                                 const std::pair<const char*, enum_type> (&items)[item_number]) const {
+      const embedded_entry& e(find(key, embedded_entry::kind::enum_item));
+      for (std::size_t i(0); i < item_number; ++i)
+        if (e.text == items[i].first)
+          return items[i].second;
+      throw std::string("the enum item of an embedded parameter is not among the enum value set");
+    }
+
+    /*
+     * Define every key in c from the values converted at compile time,
+     * before the files redefining some of them are read:
+     *
+     *   parameter::collection c;
+     *   defaults.install(c);
+     *   c.read_from_file("run.conf");
+     */
+    void install(collection& c) const {
+      for (std::size_t i(0); i < size; ++i)
+        set(c, parser.entries[i]);
+    }
+
+    /*
+     * Define in c every key it does not define yet, once the files are
+     * read, so that their values take precedence over the embedded
+     * ones. The files cannot use 'override' on these keys.
+     */
+    void fill(collection& c) const {
+      const std::vector<std::string> keys(c.get_keys());
+      for (std::size_t i(0); i < size; ++i)
+        if (not std::binary_search(keys.begin(), keys.end(), parser.entries[i].key.to_string()))
+          set(c, parser.entries[i]);
+    }
+
+  private:
+    detail::embedded_parser<size> parser;
+
+  private:
+    static void set(collection& c, const embedded_entry& e) {
+      const std::string key(e.key.to_string());
+      switch (e.k) {
+      case embedded_entry::kind::integer:
+        c.set_key_value(key, e.integer);
+        break;
+      case embedded_entry::kind::real:
+        c.set_key_value(key, e.real);
+        break;
+      case embedded_entry::kind::boolean:
+        c.set_key_value(key, e.boolean);
+        break;
+      case embedded_entry::kind::string: {
+        // the string is interpolated when read, as a parsed one
+        std::string str;
+        for (std::size_t i(0); i < e.text.size; ++i) {
+          if (e.text.data[i] == '\\' and i + 1 < e.text.size
+              and (e.text.data[i + 1] == '"' or e.text.data[i + 1] == '\\'))
+            i += 1;
+          str += e.text.data[i];
+        }
+        c.set_key_value(key, str);
+        break;
+      }
+      case embedded_entry::kind::enum_item:
+        c.set_enum_key_value(key, e.text.to_string());
+        break;
+      }
+    }
+
+    constexpr const embedded_entry& find(const char* key, embedded_entry::kind k) const {
+      for (std::size_t i(0); i < size; ++i)
+        if (parser.entries[i].key == key) {
+          if (parser.entries[i].k != k)
+            throw std::string("type mismatch on an embedded parameter");
+          return parser.entries[i];
+        }
+      throw std::string("the key is not found in the embedded parameters");
+    }
+  };
+
+  constexpr std::size_t count_embedded_parameters(const char* text) {
+    return detail::embedded_parser<0>(text, true).entry_number;
+  }
+
+  template<std::size_t size>
+  constexpr embedded_parameters<size> make_embedded_parameters(const char* text) {
+    return embedded_parameters<size>(text);
+  }
+
+}
+
+#endif /* PARAMETER_EMBEDDED_H */
@@ -0,0 +1,73 @@
+#include <fstream>
+
+#include "exporter.hpp"
+
+void print_usage(const char* program) {
+  std::cout << "usage: " << program
+            << " [-f csv|jsonl|binary] [-j threads] [-k key]... [-o output] file" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  try {
+    parameter::exporter::format f(parameter::exporter::format::csv);
+    std::size_t thread_number(0);
+    std::vector<std::string> keys;
+    std::string output, filename;
+
+    for (int i(1); i < argc; ++i) {
+      const std::string arg(argv[i]);
+      if (arg == "-f" and i + 1 < argc) {
+        const std::string name(argv[++i]);
+        if (name == "csv")
+          f = parameter::exporter::format::csv;
+        else if (name == "jsonl")
+          f = parameter::exporter::format::json_lines;
+        else if (name == "binary")
+          f = parameter::exporter::format::binary;
+        else
+          throw std::string("unknown export format '" + name + "'");
+      } else if (arg == "-j" and i + 1 < argc) {
+        thread_number = std::stoul(argv[++i]);
+      } else if (arg == "-k" and i + 1 < argc) {
+        keys.push_back(argv[++i]);
+      } else if (arg == "-o" and i + 1 < argc) {
+        output = argv[++i];
+      } else if (filename.empty()) {
+        filename = arg;
+      } else {
+        print_usage(argv[0]);
+        return 1;
+      }
+    }
+
+    if (filename.empty()) {
+      print_usage(argv[0]);
+      return 1;
+    }
+
+    parameter::collection p;
+    p.read_from_file(filename);
+
+    parameter::exporter e(f);
+    e.set_keys(keys);
+    if (thread_number)
+      e.set_thread_number(thread_number);
+
+    if (output.size()) {
+      std::ofstream o(output.c_str(), std::ios::out | std::ios::binary);
+      if (not o)
+        throw std::string("file '" + output + "' is not writable");
+      e.write(p, o);
+    } else {
+      std::ios::sync_with_stdio(false);
+      e.write(p, std::cout);
+    }
+
+    return 0;
+  }
+  catch (const std::string& e) {
+    std::cerr << e << std::endl;
+  }
+
+  return 1;
+}
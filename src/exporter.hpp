@@ -0,0 +1,556 @@
+#ifndef PARAMETER_EXPORTER_H
+#define PARAMETER_EXPORTER_H
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * Shortest decimal representation of x which reads back to the very
+   * same double. Integral values keep a trailing ".0" so that they are
+   * not mistaken for integers.
+   */
+  inline
+  void append_real(std::string& out, double x) {
+    char buffer[32];
+    for (int precision(15); precision <= 17; ++precision) {
+      std::snprintf(buffer, sizeof(buffer), "%.*g", precision, x);
+      if (precision == 17 or std::strtod(buffer, nullptr) == x)
+        break;
+    }
+    out += buffer;
+    if (std::strpbrk(buffer, ".eEni") == nullptr)
+      out += ".0";
+  }
+
+  inline
+  void append_integer(std::string& out, long long i) {
+    char buffer[24];
+    char* end(buffer + sizeof(buffer));
+    char* p(end);
+    const bool negative(i < 0);
+    unsigned long long u(negative ? 0ull - static_cast<unsigned long long>(i) : i);
+    do {
+      *--p = '0' + u % 10;
+      u /= 10;
+    } while (u);
+    if (negative)
+      *--p = '-';
+    out.append(p, end);
+  }
+
+  inline
+  void append_json_string(std::string& out, const std::string& s) {
+    out += '"';
+    for (const char ch: s) {
+      switch (ch) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(ch) < 0x20) {
+          char buffer[8];
+          std::snprintf(buffer, sizeof(buffer), "\\u%04x", ch);
+          out += buffer;
+        } else {
+          out += ch;
+        }
+      }
+    }
+    out += '"';
+  }
+
+  inline
+  void append_json_value(std::string& out, const basic_value* v) {
+    if (const value<int>* iv = dynamic_cast<const value<int>*>(v)) {
+      append_integer(out, iv->get_value());
+    } else if (const value<double>* rv = dynamic_cast<const value<double>*>(v)) {
+      // JSON has no representation for infinities and NaN
+      if (std::isfinite(rv->get_value()))
+        append_real(out, rv->get_value());
+      else
+        out += "null";
+    } else if (const value<bool>* bv = dynamic_cast<const value<bool>*>(v)) {
+      out += bv->get_value() ? "true" : "false";
+    } else if (const value<std::string>* sv = dynamic_cast<const value<std::string>*>(v)) {
+      append_json_string(out, sv->get_value());
+    } else if (const enum_value* ev = dynamic_cast<const enum_value*>(v)) {
+      append_json_string(out, ev->get_token_value());
+    } else {
+      append_json_string(out, v->print_value());
+    }
+  }
+
+  /*
+   * Stream every point of the collection as CSV, JSON lines or a binary
+   * columnar table. Points are formatted in chunks by a pool of threads,
+   * all reading the collection without changing its current point, and
+   * written in order to the output stream.
+   *
+   * The value of a key only changes with the dimensions it depends on:
+   * it is evaluated and formatted once per combination of their values,
+   * and each point copies the text of its combination. Keys depending
+   * on nearly as many combinations as there are points are evaluated at
+   * each point instead.
+   *
+   * The binary table is made of a header, a sequence of row groups and
+   * a trailer, all integers being little endian:
+   *
+   *   header:    "PRMTAB01", uint64 column number,
+   *              per column: uint8 type, uint32 name size, name
+   *   row group: uint64 row number n, then for each column
+   *              integer: n int32, real: n float64, boolean: n uint8,
+   *              string and enum: n + 1 uint64 offsets and the bytes
+   *   trailer:   uint64 0, uint64 total row number
+   *
+   * The column types are the ones of the first point.
+   */
+  class exporter {
+  public:
+    enum class format { csv, json_lines, binary };
+
+    enum class column_type: std::uint8_t {
+      integer = 0, real = 1, boolean = 2, string = 3, enumeration = 4
+    };
+
+    exporter(format f)
+      : f(f),
+        thread_number(std::max(1u, std::thread::hardware_concurrency())),
+        chunk_size(4096) {}
+
+    void set_thread_number(std::size_t n) { thread_number = std::max<std::size_t>(1, n); }
+    void set_chunk_size(std::size_t n) { chunk_size = std::max<std::size_t>(1, n); }
+
+    /*
+     * Restrict the exported columns, all the keys are exported by
+     * default.
+     */
+    void set_keys(const std::vector<std::string>& k) { keys = k; }
+
+    void write(const collection& c, std::ostream& stream) const {
+      const std::vector<std::string> keys_to_write(keys.size() ? keys : c.get_keys());
+      const std::size_t point_number(c.get_collection_size());
+      const std::size_t chunk_number((point_number + chunk_size - 1) / chunk_size);
+
+      if (f == format::binary and not is_little_endian())
+        throw std::string("the binary table format is only supported on little endian hosts");
+
+      std::vector<column> columns;
+      for (const auto& key: keys_to_write)
+        columns.push_back(make_column(c, key, point_number));
+      format_cells(c, columns);
+
+      std::string header;
+      write_header(columns, header);
+      stream.write(header.data(), header.size());
+
+      // chunks are produced out of order, at most window of them are
+      // kept in memory waiting for their turn to be written
+      const std::size_t window(2 * thread_number);
+      std::vector<std::string> slots(window);
+      std::vector<bool> ready(window, false);
+      std::atomic<std::size_t> next_chunk(0);
+      std::size_t written_chunk(0);
+      std::string error;
+      std::mutex m;
+      std::condition_variable cv;
+
+      auto worker = [&]() {
+        std::string buffer;
+
+        for (std::size_t chunk(next_chunk++); chunk < chunk_number; chunk = next_chunk++) {
+          {
+            std::unique_lock<std::mutex> lock(m);
+            cv.wait(lock, [&]() { return chunk < written_chunk + window or error.size(); });
+            if (error.size())
+              return;
+          }
+
+          buffer.clear();
+          try {
+            const std::size_t first(chunk * chunk_size);
+            write_chunk(c, columns, first, std::min(first + chunk_size, point_number), buffer);
+          }
+          catch (const std::string& e) {
+            std::lock_guard<std::mutex> lock(m);
+            error = e;
+            cv.notify_all();
+            return;
+          }
+
+          std::lock_guard<std::mutex> lock(m);
+          std::swap(slots[chunk % window], buffer);
+          ready[chunk % window] = true;
+          cv.notify_all();
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (std::size_t i(0); i < std::min(thread_number, chunk_number); ++i)
+        threads.push_back(std::thread(worker));
+
+      for (std::size_t chunk(0); chunk < chunk_number; ++chunk) {
+        std::string buffer;
+        {
+          std::unique_lock<std::mutex> lock(m);
+          cv.wait(lock, [&]() { return ready[chunk % window] or error.size(); });
+          if (error.size())
+            break;
+          std::swap(buffer, slots[chunk % window]);
+          ready[chunk % window] = false;
+        }
+
+        stream.write(buffer.data(), buffer.size());
+
+        std::lock_guard<std::mutex> lock(m);
+        written_chunk += 1;
+        cv.notify_all();
+      }
+
+      for (auto& t: threads)
+        t.join();
+
+      if (error.size())
+        throw error;
+
+      if (f == format::binary) {
+        std::string trailer;
+        append_pod<std::uint64_t>(trailer, 0);
+        append_pod<std::uint64_t>(trailer, point_number);
+        stream.write(trailer.data(), trailer.size());
+      }
+
+      stream.flush();
+    }
+
+  private:
+    /*
+     * A key written as a column. Its value at the point i depends on
+     * the combination
+     *
+     *   sum over the dependencies d of ((i / strides[d]) % sizes[d]) * steps[d]
+     *
+     * cells holding the formatted value of each combination, or being
+     * empty when the key is evaluated at each point. In the binary
+     * format, a cell holds the bytes of the value.
+     */
+    struct column {
+      std::string key;
+      // written before each value, "key": in JSON lines
+      std::string label;
+      column_type type;
+      std::vector<std::size_t> strides;
+      std::vector<std::size_t> sizes;
+      std::vector<std::size_t> steps;
+      std::size_t combination_number;
+      std::vector<std::string> cells;
+
+      std::size_t get_combination(std::size_t i) const {
+        std::size_t combination(0);
+        for (std::size_t d(0); d < strides.size(); ++d)
+          combination += (i / strides[d]) % sizes[d] * steps[d];
+        return combination;
+      }
+
+      // first point of the combination
+      std::size_t get_point(std::size_t combination) const {
+        std::size_t i(0);
+        for (std::size_t d(0); d < strides.size(); ++d)
+          i += (combination / steps[d]) % sizes[d] * strides[d];
+        return i;
+      }
+
+      bool is_cached() const { return cells.size(); }
+    };
+
+    // beyond, the cells of a column are not kept
+    static constexpr std::size_t max_cached_combinations = 1 << 20;
+
+    format f;
+    std::size_t thread_number;
+    std::size_t chunk_size;
+    std::vector<std::string> keys;
+
+  private:
+    static bool is_little_endian() {
+      const std::uint16_t one(1);
+      return *reinterpret_cast<const unsigned char*>(&one) == 1;
+    }
+
+    template<typename pod_type>
+    static void append_pod(std::string& out, pod_type v) {
+      out.append(reinterpret_cast<const char*>(&v), sizeof(pod_type));
+    }
+
+    static column_type get_column_type(const collection& c, const std::string& key) {
+      const basic_value* v(c.evaluate_at(key, 0));
+      const std::string type(v->get_type());
+      delete v;
+
+      if (type == "integer") return column_type::integer;
+      if (type == "real") return column_type::real;
+      if (type == "boolean") return column_type::boolean;
+      if (type == "string") return column_type::string;
+      if (type == "enum") return column_type::enumeration;
+      throw string_builder("the key '")(key)("' has a value of type ")(type)
+        (" which can not be exported").str();
+    }
+
+    column make_column(const collection& c, const std::string& key, std::size_t point_number) const {
+      column k;
+      k.key = key;
+      k.type = f == format::binary ? get_column_type(c, key) : column_type::string;
+      if (f == format::json_lines) {
+        append_json_string(k.label, key);
+        k.label += ':';
+      }
+
+      const collection::dimension_table& dimensions(c.get_dimension_table());
+      const collection::multi_index strides(dimensions.get_strides());
+      k.combination_number = 1;
+      for (const auto id: c.get_dependency_dimensions(key)) {
+        k.strides.push_back(strides[id]);
+        k.sizes.push_back(dimensions.get_size(id));
+        k.steps.push_back(k.combination_number);
+        k.combination_number *= dimensions.get_size(id);
+      }
+
+      if (k.combination_number <= max_cached_combinations and 2 * k.combination_number <= point_number)
+        k.cells.resize(k.combination_number);
+      return k;
+    }
+
+    /*
+     * Evaluate and format the cells of the cached columns, on the
+     * threads of the exporter.
+     */
+    void format_cells(const collection& c, std::vector<column>& columns) const {
+      std::vector<std::pair<std::size_t, std::size_t> > cells;
+      for (std::size_t k(0); k < columns.size(); ++k)
+        for (std::size_t j(0); j < columns[k].cells.size(); ++j)
+          cells.push_back(std::make_pair(k, j));
+
+      std::atomic<std::size_t> next_cell(0);
+      std::string error;
+      std::mutex m;
+
+      auto worker = [&]() {
+        try {
+          for (std::size_t i(next_cell++); i < cells.size(); i = next_cell++) {
+            column& k(columns[cells[i].first]);
+            format_cell(c, k, k.get_point(cells[i].second), k.cells[cells[i].second]);
+          }
+        }
+        catch (const std::string& e) {
+          std::lock_guard<std::mutex> lock(m);
+          error = e;
+          next_cell = cells.size();
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (std::size_t i(1); i < std::min(thread_number, cells.size()); ++i)
+        threads.push_back(std::thread(worker));
+      worker();
+      for (auto& t: threads)
+        t.join();
+
+      if (error.size())
+        throw error;
+    }
+
+    /*
+     * Append the value of the key at the point i to out, as text or, in
+     * the binary format, as the bytes of a value of the column type.
+     */
+    void format_cell(const collection& c, const column& k, std::size_t i, std::string& out) const {
+      const basic_value* v(c.evaluate_at(k.key, i));
+
+      if (f == format::csv) {
+        append_csv_value(out, v);
+      } else if (f == format::json_lines) {
+        append_json_value(out, v);
+      } else {
+        bool type_mismatch(false);
+        switch (k.type) {
+        case column_type::integer:
+          if (const value<int>* iv = dynamic_cast<const value<int>*>(v))
+            append_pod<std::int32_t>(out, iv->get_value());
+          else
+            type_mismatch = true;
+          break;
+        case column_type::real:
+          if (const value<double>* rv = dynamic_cast<const value<double>*>(v))
+            append_pod<double>(out, rv->get_value());
+          else
+            type_mismatch = true;
+          break;
+        case column_type::boolean:
+          if (const value<bool>* bv = dynamic_cast<const value<bool>*>(v))
+            append_pod<std::uint8_t>(out, bv->get_value());
+          else
+            type_mismatch = true;
+          break;
+        case column_type::string:
+          if (const value<std::string>* sv = dynamic_cast<const value<std::string>*>(v))
+            out += sv->get_value();
+          else
+            type_mismatch = true;
+          break;
+        case column_type::enumeration:
+          if (const enum_value* ev = dynamic_cast<const enum_value*>(v))
+            out += ev->get_token_value();
+          else
+            type_mismatch = true;
+          break;
+        }
+
+        if (type_mismatch) {
+          const std::string type(v->get_type());
+          delete v;
+          throw string_builder("the key '")(k.key)("' has a value of type ")(type)
+            (" at point ")(i)(" which differs from the type of its column").str();
+        }
+      }
+      delete v;
+    }
+
+    void write_header(const std::vector<column>& columns, std::string& out) const {
+      switch (f) {
+      case format::csv:
+        for (std::size_t i(0); i < columns.size(); ++i) {
+          if (i) out += ',';
+          append_csv_string(out, columns[i].key);
+        }
+        out += '\n';
+        break;
+
+      case format::json_lines:
+        break;
+
+      case format::binary:
+        out += "PRMTAB01";
+        append_pod<std::uint64_t>(out, columns.size());
+        for (std::size_t i(0); i < columns.size(); ++i) {
+          append_pod<std::uint8_t>(out, static_cast<std::uint8_t>(columns[i].type));
+          append_pod<std::uint32_t>(out, columns[i].key.size());
+          out += columns[i].key;
+        }
+        break;
+      }
+    }
+
+    void write_chunk(const collection& c,
+                     const std::vector<column>& columns,
+                     std::size_t first, std::size_t last,
+                     std::string& out) const {
+      if (f == format::binary) {
+        write_binary_chunk(c, columns, first, last, out);
+        return;
+      }
+
+      for (std::size_t i(first); i < last; ++i) {
+        if (f == format::json_lines)
+          out += '{';
+
+        for (std::size_t k(0); k < columns.size(); ++k) {
+          if (k)
+            out += ',';
+
+          out += columns[k].label;
+          if (columns[k].is_cached())
+            out += columns[k].cells[columns[k].get_combination(i)];
+          else
+            format_cell(c, columns[k], i, out);
+        }
+
+        if (f == format::json_lines)
+          out += '}';
+        out += '\n';
+      }
+    }
+
+    void write_binary_chunk(const collection& c,
+                            const std::vector<column>& columns,
+                            std::size_t first, std::size_t last,
+                            std::string& out) const {
+      const std::size_t n(last - first);
+      std::vector<std::string> data(columns.size());
+      std::vector<std::string> bytes(columns.size());
+      std::string cell;
+
+      for (std::size_t k(0); k < columns.size(); ++k)
+        if (columns[k].type == column_type::string or columns[k].type == column_type::enumeration)
+          append_pod<std::uint64_t>(data[k], 0);
+
+      for (std::size_t i(first); i < last; ++i)
+        for (std::size_t k(0); k < columns.size(); ++k) {
+          const std::string* value_bytes(&cell);
+          if (columns[k].is_cached()) {
+            value_bytes = &columns[k].cells[columns[k].get_combination(i)];
+          } else {
+            cell.clear();
+            format_cell(c, columns[k], i, cell);
+          }
+
+          if (columns[k].type == column_type::string or columns[k].type == column_type::enumeration) {
+            bytes[k] += *value_bytes;
+            append_pod<std::uint64_t>(data[k], bytes[k].size());
+          } else {
+            data[k] += *value_bytes;
+          }
+        }
+
+      append_pod<std::uint64_t>(out, n);
+      for (std::size_t k(0); k < columns.size(); ++k) {
+        out += data[k];
+        out += bytes[k];
+      }
+    }
+
+    static void append_csv_string(std::string& out, const std::string& s) {
+      if (s.find_first_of(",\"\n\r") == std::string::npos) {
+        out += s;
+        return;
+      }
+
+      out += '"';
+      for (const char ch: s) {
+        if (ch == '"')
+          out += '"';
+        out += ch;
+      }
+      out += '"';
+    }
+
+    static void append_csv_value(std::string& out, const basic_value* v) {
+      if (const value<int>* iv = dynamic_cast<const value<int>*>(v))
+        append_integer(out, iv->get_value());
+      else if (const value<double>* rv = dynamic_cast<const value<double>*>(v))
+        append_real(out, rv->get_value());
+      else if (const value<bool>* bv = dynamic_cast<const value<bool>*>(v))
+        out += bv->get_value() ? "true" : "false";
+      else if (const value<std::string>* sv = dynamic_cast<const value<std::string>*>(v))
+        append_csv_string(out, sv->get_value());
+      else if (const enum_value* ev = dynamic_cast<const enum_value*>(v))
+        append_csv_string(out, ev->get_token_value());
+      else
+        append_csv_string(out, v->print_value());
+    }
+  };
+
+}
+
+#endif /* PARAMETER_EXPORTER_H */
@@ -0,0 +1,257 @@
+#ifndef PARAMETER_FINGERPRINT_H
+#define PARAMETER_FINGERPRINT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * 128 bits identifying the resolved values of a point, stable across
+   * runs, processes and platforms. It is not a cryptographic hash.
+   */
+  struct fingerprint {
+    std::uint64_t high;
+    std::uint64_t low;
+
+    bool operator==(const fingerprint& f) const { return high == f.high and low == f.low; }
+    bool operator!=(const fingerprint& f) const { return not (*this == f); }
+    bool operator<(const fingerprint& f) const {
+      return high < f.high or (high == f.high and low < f.low);
+    }
+
+    fingerprint& operator+=(const fingerprint& f) {
+      low += f.low;
+      high += f.high + (low < f.low);
+      return *this;
+    }
+
+    fingerprint& operator-=(const fingerprint& f) {
+      const std::uint64_t borrow(low < f.low);
+      low -= f.low;
+      high -= f.high + borrow;
+      return *this;
+    }
+
+    std::string to_string() const {
+      static const char digits[] = "0123456789abcdef";
+      std::string str(32, '0');
+      for (std::size_t i(0); i < 16; ++i) {
+        str[15 - i] = digits[(high >> (4 * i)) & 0xf];
+        str[31 - i] = digits[(low >> (4 * i)) & 0xf];
+      }
+      return str;
+    }
+
+    /*
+     * Hash of a byte string, reading it as little endian words so that
+     * the result does not depend on the platform.
+     */
+    static fingerprint of(const std::string& bytes) {
+      std::uint64_t h1(0x9e3779b97f4a7c15ull ^ (bytes.size() * 0xc2b2ae3d27d4eb4full));
+      std::uint64_t h2(0x165667b19e3779f9ull ^ bytes.size());
+
+      for (std::size_t i(0); i < bytes.size(); i += 8) {
+        std::uint64_t w(0);
+        for (std::size_t j(0); j < 8 and i + j < bytes.size(); ++j)
+          w |= static_cast<std::uint64_t>(static_cast<unsigned char>(bytes[i + j])) << (8 * j);
+
+        h1 = mix(h1 ^ w);
+        h2 = mix(h2 + w * 0x87c37b91114253d5ull);
+      }
+
+      fingerprint f = { mix(h1 + h2), mix(h2 ^ (h1 >> 29)) };
+      return f;
+    }
+
+  private:
+    static std::uint64_t mix(std::uint64_t x) {
+      x ^= x >> 32;
+      x *= 0xd6e8feb86659fd93ull;
+      x ^= x >> 32;
+      x *= 0xd6e8feb86659fd93ull;
+      x ^= x >> 32;
+      return x;
+    }
+  };
+
+  /*
+   * Fingerprint of the current point of a collection, computed from
+   * the resolved values of its keys:
+   *
+   *   point_fingerprinter fp(c);
+   *   for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+   *     c.set_current_collection(i);
+   *     const fingerprint f(fp.get());
+   *     ...
+   *   }
+   *
+   * Each key contributes the hash of its name, the type of its value
+   * and the exact bytes of the value (the bits of a real), and the
+   * contributions are summed, so that the fingerprint does not depend
+   * on the order of the definitions. References and interpolations are
+   * resolved first: two files, or two points of a sweep, giving the
+   * same values to the keys have the same fingerprint. A key only
+   * contributes again when the value id of its dimension changed since
+   * the previous call, except the keys whose values depend on other
+   * keys, which are resolved at every call.
+   */
+  class point_fingerprinter {
+  public:
+    /*
+     * All the keys of the collection, or only the given ones, for
+     * instance to leave out the output file names.
+     */
+    point_fingerprinter(const collection& c)
+      : point_fingerprinter(c, c.get_keys()) {}
+
+    point_fingerprinter(const collection& c, const std::vector<std::string>& keys)
+      : c(c), dimension_number(collection::dimension_table::no_dimension) {
+      for (const auto& key: keys) {
+        term t;
+        t.key = key;
+        t.dimension = collection::dimension_table::no_dimension;
+        t.is_dependent = false;
+        t.is_valid = false;
+        t.value_id = 0;
+        t.f.high = t.f.low = 0;
+        terms.push_back(t);
+      }
+      sum.high = sum.low = 0;
+    }
+
+    fingerprint get() {
+      if (dimension_number != c.get_dimension_table().get_dimension_number()) {
+        // first call, or a key was turned into a dimension
+        dimension_number = c.get_dimension_table().get_dimension_number();
+        for (auto& t: terms) {
+          if (t.is_valid)
+            sum -= t.f;
+          locate(t);
+        }
+      }
+
+      const collection::multi_index& point(c.get_current_point());
+      for (auto& t: terms) {
+        const std::size_t id(t.dimension == collection::dimension_table::no_dimension ?
+                             0 : point[t.dimension]);
+        if (t.is_valid and id == t.value_id and not t.is_dependent)
+          continue;
+
+        if (t.is_valid)
+          sum -= t.f;
+        t.f = fingerprint::of(encode(t.key));
+        t.value_id = id;
+        t.is_valid = true;
+        sum += t.f;
+      }
+
+      return sum;
+    }
+
+    /*
+     * To call when keys were redefined, which keeps their value ids.
+     */
+    void reset() {
+      dimension_number = collection::dimension_table::no_dimension;
+    }
+
+    /*
+     * Byte string hashed for a key: its name, the type of its resolved
+     * value and the value itself, each prefixed by its length. Numbers,
+     * column elements included, are written as 8 little endian bytes,
+     * so that the fingerprint does not depend on the platform.
+     */
+    std::string encode(const std::string& key) const {
+      const basic_value* v(c.get_resolved_value(key));
+      std::string bytes;
+      append_text(bytes, key);
+
+      if (const value<int>* i = dynamic_cast<const value<int>*>(v)) {
+        bytes += 'i';
+        append_integer(bytes, static_cast<std::uint64_t>(static_cast<std::int64_t>(i->get_value())));
+      } else if (const value<double>* d = dynamic_cast<const value<double>*>(v)) {
+        std::uint64_t bits;
+        const double x(d->get_value());
+        std::memcpy(&bits, &x, sizeof(bits));
+        bytes += 'r';
+        append_integer(bytes, bits);
+      } else if (const value<bool>* b = dynamic_cast<const value<bool>*>(v)) {
+        bytes += 'b';
+        append_integer(bytes, b->get_value());
+      } else if (const value<std::string>* str = dynamic_cast<const value<std::string>*>(v)) {
+        bytes += 's';
+        append_text(bytes, str->get_value());
+      } else if (const enum_value* e = dynamic_cast<const enum_value*>(v)) {
+        bytes += 'e';
+        append_text(bytes, e->get_token_value());
+      } else if (const column_value<int>* ci = dynamic_cast<const column_value<int>*>(v)) {
+        bytes += 'I';
+        append_integer(bytes, ci->get_size());
+        for (std::size_t k(0); k < ci->get_size(); ++k)
+          append_integer(bytes, static_cast<std::uint64_t>(static_cast<std::int64_t>(ci->get_data()[k])));
+      } else if (const column_value<double>* cr = dynamic_cast<const column_value<double>*>(v)) {
+        bytes += 'R';
+        append_integer(bytes, cr->get_size());
+        for (std::size_t k(0); k < cr->get_size(); ++k) {
+          std::uint64_t bits;
+          std::memcpy(&bits, cr->get_data() + k, sizeof(bits));
+          append_integer(bytes, bits);
+        }
+      } else {
+        const std::string type(v->get_type());
+        delete v;
+        throw std::string("the key '" + key + "' has a value of type " + type
+                          + " which cannot be fingerprinted");
+      }
+
+      delete v;
+      return bytes;
+    }
+
+  private:
+    struct term {
+      std::string key;
+      std::size_t dimension;
+      bool is_dependent;
+      bool is_valid;
+      std::size_t value_id;
+      fingerprint f;
+    };
+
+    const collection& c;
+    std::vector<term> terms;
+    std::size_t dimension_number;
+    fingerprint sum;
+
+  private:
+    void locate(term& t) const {
+      const collection::multi_value& mv(c.get_multi_value(t.key));
+      t.dimension = mv.get_index_id();
+      t.is_dependent = false;
+      for (const auto v: mv.values)
+        if (dynamic_cast<const value_ref*>(v)
+            or (dynamic_cast<const value<std::string>*>(v)
+                and get_interpolated_keys(static_cast<const value<std::string>*>(v)->get_value()).size()))
+          t.is_dependent = true;
+      t.is_valid = false;
+    }
+
+    static void append_integer(std::string& bytes, std::uint64_t x) {
+      for (std::size_t i(0); i < 8; ++i)
+        bytes += static_cast<char>((x >> (8 * i)) & 0xff);
+    }
+
+    static void append_text(std::string& bytes, const std::string& str) {
+      append_integer(bytes, str.size());
+      bytes += str;
+    }
+  };
+
+}
+
+#endif /* PARAMETER_FINGERPRINT_H */
@@ -0,0 +1,242 @@
+#ifndef PARAMETER_INSTRUMENTATION_H
+#define PARAMETER_INSTRUMENTATION_H
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * The recording hooks are only compiled in when PARAMETER_INSTRUMENTATION
+ * is defined. Otherwise PARAMETER_INSTRUMENT expands to nothing and the
+ * lookup path is identical to the non-instrumented one.
+ */
+#ifdef PARAMETER_INSTRUMENTATION
+#define PARAMETER_INSTRUMENT(stats, statement)  \
+  do { if ((stats).is_enabled()) { statement; } } while (0)
+#else
+#define PARAMETER_INSTRUMENT(stats, statement) do {} while (0)
+#endif
+
+namespace parameter {
+
+  class instrumentation {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct key_statistics {
+      std::size_t get_value_calls;
+      std::size_t get_enum_value_calls;
+      std::size_t get_basic_value_calls;
+      clock::duration eval_time;
+      std::size_t max_interpolation_depth;
+
+      key_statistics()
+        : get_value_calls(0), get_enum_value_calls(0), get_basic_value_calls(0),
+          eval_time(clock::duration::zero()), max_interpolation_depth(0) {}
+
+      std::size_t get_read_number() const {
+        return get_value_calls + get_enum_value_calls + get_basic_value_calls;
+      }
+    };
+
+    struct file_statistics {
+      std::size_t parse_number;
+      clock::duration parse_time;
+
+      file_statistics(): parse_number(0), parse_time(clock::duration::zero()) {}
+    };
+
+    instrumentation(): enabled(false) {}
+
+    instrumentation(const instrumentation& s): enabled(s.enabled) {
+      std::lock_guard<std::mutex> lock(s.m);
+      keys = s.keys;
+      files = s.files;
+    }
+
+    instrumentation& operator=(const instrumentation& s) {
+      instrumentation copy(s);
+      std::lock_guard<std::mutex> lock(m);
+      enabled = copy.enabled;
+      keys.swap(copy.keys);
+      files.swap(copy.files);
+      return *this;
+    }
+
+    /*
+     * Whether the library was compiled with PARAMETER_INSTRUMENTATION,
+     * whatever the definitions of the program including this header.
+     */
+    static bool is_available();
+
+    bool is_enabled() const { return enabled; }
+
+    void enable() {
+      if (not is_available())
+        throw std::string("the parameter library was compiled without "
+                          "PARAMETER_INSTRUMENTATION, instrumentation is not available");
+      enabled = true;
+    }
+
+    void disable() { enabled = false; }
+
+    void reset() {
+      std::lock_guard<std::mutex> lock(m);
+      keys.clear();
+      files.clear();
+    }
+
+    /*
+     * The collection records the reads of its const accessors, which
+     * may run on several threads: the statistics are updated under a
+     * lock, and the depth of the interpolations is followed per thread.
+     */
+    void record_get_value(const std::string& key) {
+      std::lock_guard<std::mutex> lock(m);
+      keys[key].get_value_calls += 1;
+    }
+
+    void record_get_enum_value(const std::string& key) {
+      std::lock_guard<std::mutex> lock(m);
+      keys[key].get_enum_value_calls += 1;
+    }
+
+    void record_get_basic_value(const std::string& key) {
+      std::lock_guard<std::mutex> lock(m);
+      keys[key].get_basic_value_calls += 1;
+    }
+
+    /*
+     * begin_eval and end_eval bracket the top level evaluation of a
+     * value, enter_interpolation and leave_interpolation bracket each
+     * nested string interpolation happening in between on the same
+     * thread.
+     */
+    clock::time_point begin_eval() {
+      interpolation_state& s(get_interpolation_state());
+      s.max_depth = s.depth;
+      return clock::now();
+    }
+
+    void end_eval(const std::string& key, clock::time_point start) {
+      const clock::duration d(clock::now() - start);
+      const std::size_t depth(get_interpolation_state().max_depth);
+
+      std::lock_guard<std::mutex> lock(m);
+      key_statistics& s(keys[key]);
+      s.eval_time += d;
+      s.max_interpolation_depth = std::max(s.max_interpolation_depth, depth);
+    }
+
+    void enter_interpolation() {
+      interpolation_state& s(get_interpolation_state());
+      s.depth += 1;
+      s.max_depth = std::max(s.max_depth, s.depth);
+    }
+
+    void leave_interpolation() { get_interpolation_state().depth -= 1; }
+
+    void record_parse(const std::string& filename, clock::duration d) {
+      std::lock_guard<std::mutex> lock(m);
+      file_statistics& s(files[filename]);
+      s.parse_number += 1;
+      s.parse_time += d;
+    }
+
+    std::map<std::string, key_statistics> get_key_statistics() const {
+      std::lock_guard<std::mutex> lock(m);
+      return keys;
+    }
+
+    std::map<std::string, file_statistics> get_file_statistics() const {
+      std::lock_guard<std::mutex> lock(m);
+      return files;
+    }
+
+    bool is_read(const std::string& key) const {
+      std::lock_guard<std::mutex> lock(m);
+      const auto s(keys.find(key));
+      return s != keys.end() and s->second.get_read_number() > 0;
+    }
+
+    void print(std::ostream& stream) const {
+      std::lock_guard<std::mutex> lock(m);
+      stream << "key access statistics:" << std::endl;
+      stream << std::setw(32) << std::left << "  key"
+             << std::right
+             << std::setw(10) << "value"
+             << std::setw(10) << "enum"
+             << std::setw(10) << "basic"
+             << std::setw(14) << "eval [us]"
+             << std::setw(8) << "depth" << std::endl;
+      for (const auto& k: keys)
+        stream << "  " << std::setw(30) << std::left << k.first
+               << std::right
+               << std::setw(10) << k.second.get_value_calls
+               << std::setw(10) << k.second.get_enum_value_calls
+               << std::setw(10) << k.second.get_basic_value_calls
+               << std::setw(14) << to_microseconds(k.second.eval_time)
+               << std::setw(8) << k.second.max_interpolation_depth << std::endl;
+
+      stream << "file parse statistics:" << std::endl;
+      for (const auto& f: files)
+        stream << "  " << f.first << ": parsed " << f.second.parse_number
+               << " time(s) in " << to_microseconds(f.second.parse_time) << " us" << std::endl;
+    }
+
+  private:
+    struct interpolation_state {
+      std::size_t depth;
+      std::size_t max_depth;
+    };
+
+    bool enabled;
+
+    mutable std::mutex m;
+    std::map<std::string, key_statistics> keys;
+    std::map<std::string, file_statistics> files;
+
+  private:
+    static interpolation_state& get_interpolation_state();
+
+    static double to_microseconds(clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count();
+    }
+  };
+
+  /*
+   * Approximate heap footprint of a collection, per key and per value
+   * kind, as returned by collection::get_memory_usage.
+   */
+  struct memory_usage {
+    std::size_t total;
+    std::map<std::string, std::size_t> by_key;
+    std::map<std::string, std::size_t> by_kind;
+
+    memory_usage(): total(0) {}
+
+    void print(std::ostream& stream) const {
+      stream << "memory usage: " << total << " bytes" << std::endl;
+      stream << "by value kind:" << std::endl;
+      for (const auto& k: by_kind)
+        stream << "  " << std::setw(10) << std::left << k.first
+               << std::right << std::setw(12) << k.second << std::endl;
+      stream << "by key:" << std::endl;
+      for (const auto& k: by_key)
+        stream << "  " << std::setw(30) << std::left << k.first
+               << std::right << std::setw(12) << k.second << std::endl;
+    }
+  };
+
+  inline
+  std::size_t get_dynamic_footprint(const std::string& s) {
+    // short strings are stored in place by every mainstream implementation
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+  }
+}
+
+#endif /* PARAMETER_INSTRUMENTATION_H */
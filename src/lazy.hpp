@@ -0,0 +1,483 @@
+#ifndef PARAMETER_LAZY_H
+#define PARAMETER_LAZY_H
+
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace parameter {
+
+  /*
+   * Text of a parameter file indexed by the lazy scanner. The values
+   * keep it alive until they are materialized.
+   */
+  struct lazy_source {
+    std::string name;
+    std::string text;
+
+    std::string render_coordinates(std::size_t offset) const {
+      std::size_t line(1), column(1);
+      for (std::size_t i(0); i < offset and i < text.size(); ++i) {
+        if (text[i] == '\n') {
+          line += 1;
+          column = 1;
+        } else {
+          column += 1;
+        }
+      }
+      return render_coordinates(line, column);
+    }
+
+    /*
+     * Same rendering as the tokens of the lexer, which the parser
+     * checks before using the lazy scanner.
+     */
+    std::string render_coordinates(std::size_t line, std::size_t column) const {
+      std::ostringstream oss;
+      oss << name << ":" << line << ":" << column;
+      return oss.str();
+    }
+  };
+
+  struct lazy_token {
+    enum class kind {
+      key, boolean, string, real, integer, equal, enum_item,
+      import, override_keyword, comma, lbracket, rbracket,
+      lbrace, rbrace, lparen, rparen, eoi
+    };
+
+    kind k;
+    std::size_t offset;
+    std::size_t length;
+  };
+
+  /*
+   * Token rules of the parameter files, in the order given to the
+   * lexer. build_lexer emits them, and the lazy scanner matches the
+   * same tokens by hand and breaks ties in the same order, the later
+   * rule winning.
+   */
+  struct token_rule {
+    lazy_token::kind k;
+    const char* pattern;
+  };
+
+  constexpr token_rule token_rules[] = {
+    { lazy_token::kind::key, "[-_a-zA-Z0-9]+(\\.[-_a-zA-Z0-9]+)*" },
+    { lazy_token::kind::boolean, "(true)|(false)|(yes)|(no)|(on)|(off)" },
+    { lazy_token::kind::string, "\"([^\"\\\\]|(\\\\\")|(\\\\\\\\))*\"" },
+    { lazy_token::kind::real,
+      "[+-]?"
+      "((\\.\\d+)|(\\d+\\.)|(\\d+\\.\\d+)|(\\d+))"
+      "([eE][+-]?\\d+)?" },
+    { lazy_token::kind::integer, "[+-]?\\d+" },
+    { lazy_token::kind::equal, "=|:|(->)" },
+    { lazy_token::kind::enum_item, "#[-_a-zA-Z0-9]+" },
+    { lazy_token::kind::import, "import" },
+    { lazy_token::kind::override_keyword, "override" },
+    { lazy_token::kind::comma, "," },
+    { lazy_token::kind::lbracket, "\\[" },
+    { lazy_token::kind::rbracket, "\\]" },
+    { lazy_token::kind::lbrace, "\\{" },
+    { lazy_token::kind::rbrace, "\\}" },
+    { lazy_token::kind::lparen, "\\(" },
+    { lazy_token::kind::rparen, "\\)" }
+  };
+
+  // blanks and comments between the tokens
+  constexpr const char* blank_pattern = "(\\s|(;[^\\n]*\\n))*";
+
+  /*
+   * Location of a definition in the text: the values are the
+   * value_number value tokens separated by commas from value_offset.
+   */
+  struct lazy_definition {
+    bool is_overriding;
+    std::size_t key_offset;
+    std::size_t key_length;
+    std::size_t line;
+    std::size_t column;
+    std::size_t value_offset;
+    std::size_t value_number;
+  };
+
+  /*
+   * A statement refers to its definitions as a range of the definitions
+   * found by the scanner.
+   */
+  struct lazy_statement {
+    enum class kind { definition, group, import };
+
+    kind k;
+    std::size_t first_definition;
+    std::size_t definition_number;
+    lazy_token import_filename;
+  };
+
+  /*
+   * Hand written scanner recognizing the statements of a parameter file
+   * without converting the values. It accepts the tokens of build_lexer
+   * with the same longest match rule, and the definitions, groups and
+   * file imports of the grammar. On anything else scan returns false,
+   * and the file is parsed by the regular parser instead, which reports
+   * the error.
+   */
+  class lazy_scanner {
+  public:
+    /*
+     * The scan starts at position, which must be at the start of a
+     * line or of a token, like the value_offset of a definition.
+     */
+    lazy_scanner(const std::string& text, std::size_t position = 0)
+      : text(text), position(position), counted(0), line(1), line_start(0) {}
+
+    /*
+     * Locate the statements of the text, the values being matched but
+     * neither stored nor converted.
+     */
+    bool scan(std::vector<lazy_statement>& statements, std::vector<lazy_definition>& definitions) {
+      lazy_token t;
+      if (not next(t))
+        return false;
+
+      while (t.k != lazy_token::kind::eoi) {
+        lazy_statement s;
+        s.first_definition = definitions.size();
+        switch (t.k) {
+        case lazy_token::kind::import:
+          if (not next(s.import_filename) or s.import_filename.k != lazy_token::kind::string)
+            return false;
+          s.k = lazy_statement::kind::import;
+          if (not next(t))
+            return false;
+          break;
+
+        case lazy_token::kind::lbracket:
+          s.k = lazy_statement::kind::group;
+          if (not next(t))
+            return false;
+          while (t.k != lazy_token::kind::rbracket) {
+            definitions.push_back(lazy_definition());
+            if (not scan_definition(t, definitions.back()))
+              return false;
+          }
+          if (not next(t))
+            return false;
+          break;
+
+        case lazy_token::kind::key:
+        case lazy_token::kind::override_keyword:
+          s.k = lazy_statement::kind::definition;
+          definitions.push_back(lazy_definition());
+          if (not scan_definition(t, definitions.back()))
+            return false;
+          break;
+
+        default:
+          return false;
+        }
+
+        s.definition_number = definitions.size() - s.first_definition;
+        statements.push_back(s);
+      }
+
+      return true;
+    }
+
+    /*
+     * Split the whole text in tokens, the end of input included.
+     */
+    bool tokenize(std::vector<lazy_token>& tokens) {
+      lazy_token t;
+      do {
+        if (not next(t))
+          return false;
+        tokens.push_back(t);
+      } while (t.k != lazy_token::kind::eoi);
+      return true;
+    }
+
+    /*
+     * Remove the quoting characters and the escaping backslashes, as
+     * string_token_to_string does.
+     */
+    std::string unescape(const lazy_token& t) const {
+      std::string str;
+      str.reserve(t.length - 2);
+      for (std::size_t i(t.offset + 1); i < t.offset + t.length - 1; ++i) {
+        if (text[i] == '\\')
+          i += 1;
+        if (i < t.offset + t.length - 1)
+          str.push_back(text[i]);
+      }
+      return str;
+    }
+
+    /*
+     * Next token from the current position, false if no token rule
+     * matches.
+     */
+    bool next(lazy_token& t) {
+      if (not skip())
+        return false;
+
+      t.offset = position;
+      t.length = 0;
+      if (position == text.size()) {
+        t.k = lazy_token::kind::eoi;
+        return true;
+      }
+
+      // longest match, in the order of the lexer rules for a tie
+      const std::size_t key_length(match_key(position));
+      for (const auto& rule: token_rules) {
+        const std::size_t length(match(rule.k, key_length));
+        if (length and length >= t.length) {
+          t.k = rule.k;
+          t.length = length;
+        }
+      }
+
+      if (t.length == 0)
+        return false;
+
+      position += t.length;
+      return true;
+    }
+
+  private:
+    const std::string& text;
+    std::size_t position;
+
+    // lines are counted up to counted, which only moves forward
+    std::size_t counted;
+    std::size_t line;
+    std::size_t line_start;
+
+  private:
+    /*
+     * On entry t is the first token of the definition, on exit the
+     * first token following it.
+     */
+    bool scan_definition(lazy_token& t, lazy_definition& d) {
+      d.is_overriding = t.k == lazy_token::kind::override_keyword;
+      if (d.is_overriding and not next(t))
+        return false;
+
+      if (t.k != lazy_token::kind::key)
+        return false;
+      d.key_offset = t.offset;
+      d.key_length = t.length;
+
+      if (not next(t) or t.k != lazy_token::kind::equal)
+        return false;
+      count_lines(t.offset);
+      d.line = line;
+      d.column = t.offset - line_start + 1;
+      d.value_number = 0;
+
+      while (true) {
+        if (not next(t))
+          return false;
+
+        switch (t.k) {
+        case lazy_token::kind::key:
+        case lazy_token::kind::boolean:
+        case lazy_token::kind::string:
+        case lazy_token::kind::real:
+        case lazy_token::kind::integer:
+        case lazy_token::kind::enum_item:
+          if (d.value_number == 0)
+            d.value_offset = t.offset;
+          d.value_number += 1;
+          break;
+        default:
+          return false;
+        }
+
+        if (not next(t))
+          return false;
+        if (t.k != lazy_token::kind::comma)
+          return true;
+      }
+    }
+
+    void count_lines(std::size_t offset) {
+      const char* p(text.data() + counted);
+      const char* end(text.data() + offset);
+      while ((p = static_cast<const char*>(std::memchr(p, '\n', end - p)))) {
+        line += 1;
+        p += 1;
+        line_start = p - text.data();
+      }
+      counted = offset;
+    }
+
+    static bool is_key_character(char c) {
+      return (c >= 'a' and c <= 'z') or (c >= 'A' and c <= 'Z') or (c >= '0' and c <= '9')
+        or c == '-' or c == '_';
+    }
+
+    static bool is_digit(char c) { return c >= '0' and c <= '9'; }
+
+    // [-_a-zA-Z0-9]+(\.[-_a-zA-Z0-9]+)*
+    std::size_t match_key(std::size_t i) const {
+      std::size_t length(0);
+      while (i + length < text.size() and is_key_character(text[i + length]))
+        length += 1;
+      while (length and i + length + 1 < text.size()
+             and text[i + length] == '.' and is_key_character(text[i + length + 1])) {
+        length += 1;
+        while (i + length < text.size() and is_key_character(text[i + length]))
+          length += 1;
+      }
+      return length;
+    }
+
+    std::size_t digits_from(std::size_t i) const {
+      std::size_t n(0);
+      while (i + n < text.size() and is_digit(text[i + n]))
+        n += 1;
+      return n;
+    }
+
+    // [+-]?((\.\d+)|(\d+\.)|(\d+\.\d+)|(\d+))([eE][+-]?\d+)?
+    std::size_t match_real(std::size_t i) const {
+      const std::size_t begin(i);
+      if (i < text.size() and (text[i] == '+' or text[i] == '-'))
+        i += 1;
+
+      const std::size_t integral(digits_from(i));
+      i += integral;
+      if (i < text.size() and text[i] == '.') {
+        const std::size_t fractional(digits_from(i + 1));
+        if (integral == 0 and fractional == 0)
+          return 0;
+        i += 1 + fractional;
+      } else if (integral == 0) {
+        return 0;
+      }
+
+      if (i < text.size() and (text[i] == 'e' or text[i] == 'E')) {
+        std::size_t j(i + 1);
+        if (j < text.size() and (text[j] == '+' or text[j] == '-'))
+          j += 1;
+        const std::size_t exponent(digits_from(j));
+        if (exponent)
+          i = j + exponent;
+      }
+
+      return i - begin;
+    }
+
+    std::size_t match_integer(std::size_t i) const {
+      const std::size_t sign(i < text.size() and (text[i] == '+' or text[i] == '-') ? 1 : 0);
+      const std::size_t digits(digits_from(i + sign));
+      return digits ? sign + digits : 0;
+    }
+
+    // ([^"\\]|(\\")|(\\\\))*
+    std::size_t match_string(std::size_t i) const {
+      if (text[i] != '"')
+        return 0;
+      for (std::size_t j(i + 1); j < text.size(); ++j) {
+        if (text[j] == '"')
+          return j + 1 - i;
+        if (text[j] == '\\') {
+          if (j + 1 < text.size() and (text[j + 1] == '"' or text[j + 1] == '\\'))
+            j += 1;
+          else
+            return 0;
+        }
+      }
+      return 0;
+    }
+
+    bool is_word(std::size_t i, std::size_t length, const char* word) const {
+      return std::strlen(word) == length and text.compare(i, length, word) == 0;
+    }
+
+    /*
+     * Length of the token of the rule at the current position, zero if
+     * it does not match.
+     */
+    std::size_t match(lazy_token::kind k, std::size_t key_length) const {
+      const char c(text[position]);
+      switch (k) {
+      case lazy_token::kind::key:
+        return key_length;
+      case lazy_token::kind::boolean:
+        return (is_word(position, key_length, "true") or is_word(position, key_length, "false")
+                or is_word(position, key_length, "yes") or is_word(position, key_length, "no")
+                or is_word(position, key_length, "on") or is_word(position, key_length, "off")) ?
+          key_length : 0;
+      case lazy_token::kind::string:
+        return match_string(position);
+      case lazy_token::kind::real:
+        return match_real(position);
+      case lazy_token::kind::integer:
+        return match_integer(position);
+      case lazy_token::kind::equal:
+        if (c == '-' and position + 1 < text.size() and text[position + 1] == '>')
+          return 2;
+        return c == '=' or c == ':' ? 1 : 0;
+      case lazy_token::kind::enum_item: {
+        if (c != '#')
+          return 0;
+        std::size_t length(1);
+        while (position + length < text.size() and is_key_character(text[position + length]))
+          length += 1;
+        return length > 1 ? length : 0;
+      }
+      case lazy_token::kind::import:
+        return is_word(position, key_length, "import") ? key_length : 0;
+      case lazy_token::kind::override_keyword:
+        return is_word(position, key_length, "override") ? key_length : 0;
+      case lazy_token::kind::comma:
+        return c == ',' ? 1 : 0;
+      case lazy_token::kind::lbracket:
+        return c == '[' ? 1 : 0;
+      case lazy_token::kind::rbracket:
+        return c == ']' ? 1 : 0;
+      case lazy_token::kind::lbrace:
+        return c == '{' ? 1 : 0;
+      case lazy_token::kind::rbrace:
+        return c == '}' ? 1 : 0;
+      case lazy_token::kind::lparen:
+        return c == '(' ? 1 : 0;
+      case lazy_token::kind::rparen:
+        return c == ')' ? 1 : 0;
+      case lazy_token::kind::eoi:
+        break;
+      }
+      return 0;
+    }
+
+    /*
+     * Skip blanks and comments as (\s|(;[^\n]*\n))* does, a comment
+     * must thus be terminated by a new line.
+     */
+    bool skip() {
+      while (position < text.size()) {
+        const char c(text[position]);
+        if (c == ' ' or c == '\t' or c == '\n' or c == '\r' or c == '\v' or c == '\f') {
+          position += 1;
+        } else if (c == ';') {
+          const std::size_t end(text.find('\n', position));
+          if (end == std::string::npos)
+            return false;
+          position = end + 1;
+        } else {
+          break;
+        }
+      }
+      return true;
+    }
+  };
+
+}
+
+#endif /* PARAMETER_LAZY_H */
@@ -1,68 +1,30 @@
-#include "parameter.hpp"
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+#include <spikes/array.hpp>
+
+#include "parser.hpp"
 
 namespace parameter {
 
-  std::ostream& operator<<(std::ostream& stream, symbol s) {
-    switch (s) {
-    case symbol::eoi:
-      stream << "<eoi>"; break;
-    case symbol::key:
-      stream << "<key>"; break;
-    case symbol::import:
-      stream << "<import>"; break;
-    case symbol::equal:
-      stream << "<equal>"; break;
-    case symbol::value:
-      stream << "<value>"; break;
-    case symbol::string:
-      stream << "<string>"; break;
-    case symbol::real:
-      stream << "<real>"; break;
-    case symbol::integer:
-      stream << "<integer>"; break;
-    case symbol::boolean:
-      stream << "<boolean>"; break;
-    case symbol::enum_item:
-      stream << "<enum_token>"; break;
-    case symbol::override_keyword:
-      stream << "<override>"; break;
-    case symbol::comma:
-      stream << "<comma>"; break;
-    case symbol::lbracket:
-      stream << "<lbracket>"; break;
-    case symbol::rbracket:
-      stream << "<rbracket>"; break;
-    }
-    return stream;
-  }
+  constexpr const char* const basic_value::type_names[4];
 
-  
-  regex_lexer<token_type> build_lexer() {
-    regex_lexer_builder<token_type> rlb(symbol::eoi); {
-      rlb.emit(symbol::key, "[-_a-zA-Z0-9]+");
-      rlb.emit(symbol::boolean, "(true)|(false)|(yes)|(no)|(on)|(off)");
-      rlb.emit(symbol::string, "\"([^\"\\\\]|(\\\\\")|(\\\\\\\\))*\"");
-      rlb.emit(symbol::real,
-               "[+-]?"
-               "((\\.\\d+)|(\\d+\\.)|(\\d+\\.\\d+)|(\\d+))"
-               "([eE][+-]?\\d+)?");
-      rlb.emit(symbol::integer, "[+-]?\\d+");
-      rlb.emit(symbol::equal, "=|:|(->)");
-      rlb.emit(symbol::enum_item, "#[-_a-zA-Z0-9]+");
-      rlb.emit(symbol::import, "import");
-      rlb.emit(symbol::override_keyword, "override");
-      rlb.emit(symbol::comma, ",");
-      rlb.emit(symbol::lbracket, "\\[");
-      rlb.emit(symbol::rbracket, "\\]");
-      
-      rlb.skip("(\\s|(;[^\\n]*\\n))*");
-    }
-
-    return rlb.build();
-  }
+  constexpr std::size_t collection::dimension_table::no_dimension;
+  constexpr std::uint64_t collection::shared_no_dimension;
 
+  bool instrumentation::is_available() {
+#ifdef PARAMETER_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+  }
 
-  constexpr const char* const basic_value::type_names[4];
+  instrumentation::interpolation_state& instrumentation::get_interpolation_state() {
+    static thread_local interpolation_state s = { 0, 0 };
+    return s;
+  }
   
   template<>
   std::string value<std::string>::print_value() const {
@@ -97,7 +59,9 @@ namespace parameter {
         if (level == 0) {
           const std::string v_name(v.substr(opening_brace_location + 1,
                                             i - opening_brace_location - 1));
-          const basic_value* v_ptr(c.get_basic_value(v_name)->eval(c));
+          PARAMETER_INSTRUMENT(c.get_instrumentation(), c.get_instrumentation().enter_interpolation());
+          const basic_value* v_ptr(c.get_resolved_value(v_name));
+          PARAMETER_INSTRUMENT(c.get_instrumentation(), c.get_instrumentation().leave_interpolation());
           result += v_ptr->print_value();
           delete v_ptr;
         }
@@ -109,6 +73,1326 @@ namespace parameter {
     return new value<std::string>(result);
   }
   
-  const basic_value* value_ref::eval(const collection& c) const { return c.get_basic_value(key)->clone(); }
+  std::vector<std::string> get_interpolated_keys(const std::string& str) {
+    std::vector<std::string> keys;
+
+    std::size_t level(0);
+    std::size_t opening_brace_location(std::string::npos);
+    for (std::size_t i(0); i < str.size(); ++i) {
+      if (str[i] == '{') {
+        level += 1;
+        if (level == 1)
+          opening_brace_location = i;
+      } else if (str[i] == '}') {
+        if (level > 0)
+          level -= 1;
+
+        if (level == 0 and opening_brace_location != std::string::npos)
+          keys.push_back(str.substr(opening_brace_location + 1,
+                                    i - opening_brace_location - 1));
+      }
+    }
+
+    return keys;
+  }
+  
+  const basic_value* value_ref::eval(const collection& c) const { return c.get_resolved_value(key); }
+
+  template<typename value_type>
+  std::string value<value_type>::get_type() const {
+    return type_names[value_type_index<value_type>::value];
+  }
+
+  template<typename value_type>
+  std::string value<value_type>::print_value() const {
+    std::ostringstream oss; oss << v;
+    return oss.str();
+  }
+
+  template<typename value_type>
+  basic_value* value<value_type>::clone() const {
+    return new value<value_type>(*this);
+  }
+
+  template<typename value_type>
+  const basic_value* value<value_type>::eval(const collection& c) const {
+    return clone();
+  }
+
+  template<typename value_type>
+  std::size_t value<value_type>::get_memory_footprint() const {
+    return sizeof(*this);
+  }
+
+  template<>
+  std::size_t value<std::string>::get_memory_footprint() const {
+    return sizeof(*this) + get_dynamic_footprint(v);
+  }
+
+  template class value<int>;
+  template class value<bool>;
+  template class value<std::string>;
+  template class value<double>;
+
+  template<typename element_type>
+  column_value<element_type>::column_value(const table_column& c)
+    : owner(c.owner), data(static_cast<const element_type*>(c.data)), size(c.size) {}
+
+  template<typename element_type>
+  std::string column_value<element_type>::get_type() const {
+    return std::string(type_names[value_type_index<element_type>::value]) + "-column";
+  }
+
+  template<typename element_type>
+  std::string column_value<element_type>::print_value() const {
+    std::ostringstream oss;
+    oss << "[";
+    for (std::size_t i(0); i < std::min<std::size_t>(size, 3); ++i)
+      oss << (i ? ", " : "") << data[i];
+    if (size > 3)
+      oss << ", ...";
+    oss << "] (" << size << " rows)";
+    return oss.str();
+  }
+
+  template<typename element_type>
+  basic_value* column_value<element_type>::clone() const {
+    return new column_value<element_type>(*this);
+  }
+
+  template<typename element_type>
+  const basic_value* column_value<element_type>::eval(const collection& c) const {
+    return clone();
+  }
+
+  template<typename element_type>
+  std::size_t column_value<element_type>::get_memory_footprint() const {
+    return sizeof(*this);
+  }
+
+  template class column_value<int>;
+  template class column_value<double>;
+
+  std::size_t collection::dimension_table::get_point_number() const {
+    if (sizes.empty())
+      return 1;
+    return array_element_number(sizes.size(), &sizes[0]);
+  }
+
+  void collection::dimension_table::select(std::size_t i) {
+    if (sizes.empty())
+      return;
+
+    if (not is_cost_ordered) {
+      to_multi_index(sizes.size(), &selection[0], &sizes[0], i, true);
+      return;
+    }
+
+    if (order.size() != sizes.size())
+      update_order();
+    for (const auto id: order) {
+      selection[id] = i % sizes[id];
+      i /= sizes[id];
+    }
+  }
+
+  collection::multi_index collection::dimension_table::get_strides() const {
+    // single valued dimensions keep a stride of one, their value id
+    // being always zero
+    multi_index strides(sizes.size(), 1);
+    const std::size_t point_number(get_point_number());
+
+    dimension_table probe(*this);
+    std::size_t stride(1);
+    while (stride < point_number) {
+      probe.select(stride);
+      const multi_index& s(probe.get_selection());
+      const auto id(std::find(s.begin(), s.end(), std::size_t(1)) - s.begin());
+      strides[id] = stride;
+      stride *= sizes[id];
+    }
+
+    return strides;
+  }
+
+  std::mutex& collection::multi_value::get_conversion_mutex() {
+    // one lock for every collection, only taken by the first accesses
+    static std::mutex conversion_mutex;
+    return conversion_mutex;
+  }
+
+  void collection::multi_value::materialize_values() const {
+    std::lock_guard<std::mutex> lock(get_conversion_mutex());
+    if (not is_lazy.load(std::memory_order_relaxed))
+      return;
+
+    // the values are separated by commas, as scan_definition checked
+    std::vector<basic_value*> converted;
+    converted.reserve(lazy_value_number);
+    try {
+      lazy_scanner scanner(lazy_text->text, lazy_offset);
+      lazy_token t;
+      for (std::size_t i(0); i < lazy_value_number; ++i) {
+        if (i)
+          scanner.next(t);
+        scanner.next(t);
+        converted.push_back(convert_lazy_token(*lazy_text, t));
+      }
+    }
+    catch (...) {
+      for (auto v: converted)
+        delete v;
+      throw;
+    }
+
+    values.swap(converted);
+    lazy_text.reset();
+    is_lazy.store(false, std::memory_order_release);
+  }
+
+  std::size_t collection::projection_index(const std::vector<std::string>& keys) const {
+    std::size_t index(0), stride(1);
+    for (const auto id: get_projection_dimensions(keys)) {
+      index += dimensions.get_selection()[id] * stride;
+      stride *= dimensions.get_size(id);
+    }
+    return index;
+  }
+
+  std::size_t collection::get_projection_size(const std::vector<std::string>& keys) const {
+    std::size_t size(1);
+    for (const auto id: get_projection_dimensions(keys))
+      size *= dimensions.get_size(id);
+    return size;
+  }
+
+  std::vector<std::vector<std::string> > collection::get_iteration_order() const {
+    std::vector<std::vector<std::string> > keys_by_dimension(dimensions.get_dimension_number());
+    for (const auto& kv: key_value)
+      if (kv.second.get_index_id() != dimension_table::no_dimension)
+        keys_by_dimension[kv.second.get_index_id()].push_back(kv.first);
+    if (shared) {
+      for (std::size_t i(0); i < shared->get_header().key_number; ++i) {
+        const shared_key& k(shared->get_key(i));
+        if (k.index_id == shared_no_dimension)
+          continue;
+        const std::string name(shared->get_key_name(k));
+        if (key_value.find(name) == key_value.end())
+          keys_by_dimension[shared_dimension_ids[k.index_id]].push_back(name);
+      }
+      for (auto& keys: keys_by_dimension)
+        std::sort(keys.begin(), keys.end());
+    }
+
+    // the order in which select actually nests the dimensions, ties of
+    // cost included
+    const multi_index strides(dimensions.get_strides());
+    std::vector<std::size_t> order(dimensions.get_dimension_number());
+    for (std::size_t id(0); id < order.size(); ++id)
+      order[id] = id;
+    std::sort(order.begin(), order.end(),
+              [&strides](std::size_t a, std::size_t b) { return strides[a] > strides[b]; });
+
+    std::vector<std::vector<std::string> > iteration_order;
+    for (const auto id: order)
+      if (dimensions.get_size(id) > 1)
+        iteration_order.push_back(keys_by_dimension[id]);
+    return iteration_order;
+  }
+
+  std::vector<std::string> collection::apply_overrides(int argc, const char* const* argv) {
+    std::vector<std::string> remaining;
+
+    for (int i(1); i < argc; ++i) {
+      const std::string arg(argv[i]);
+      const std::string source_name(string_builder("argv[")(i)("]"));
+
+      if (arg == "--override" and i + 1 < argc) {
+        read_from_string(std::string("override ") + argv[i + 1],
+                         string_builder("argv[")(i + 1)("]"));
+        i += 1;
+      } else if (arg.compare(0, 11, "--override=") == 0) {
+        read_from_string("override " + arg.substr(11), source_name);
+      } else if (arg.compare(0, 2, "--") == 0 and arg.find('=') != std::string::npos) {
+        read_from_string(arg.substr(2), source_name);
+      } else {
+        remaining.push_back(arg);
+      }
+    }
+
+    return remaining;
+  }
+
+  void collection::set_key_value(const std::string& key, double value) {
+    set_key_value(key, new ::parameter::value<double>(value));
+    compact_dimensions();
+  }
+
+  void collection::set_key_value(const std::string& key, bool value) {
+    set_key_value(key, new ::parameter::value<bool>(value));
+    compact_dimensions();
+  }
+
+  void collection::set_key_value(const std::string& key, int value) {
+    set_key_value(key, new ::parameter::value<int>(value));
+    compact_dimensions();
+  }
+
+  void collection::set_key_value(const std::string& key, const std::string& value) {
+    set_key_value(key, new ::parameter::value<std::string>(value));
+    compact_dimensions();
+  }
+
+  void collection::set_enum_key_value(const std::string& key, const std::string& token_value) {
+    set_key_value(key, new enum_value(token_value));
+    compact_dimensions();
+  }
+
+  std::size_t collection::append_key_value(const std::string& key, double value) {
+    return append_value(key, new ::parameter::value<double>(value));
+  }
+
+  std::size_t collection::append_key_value(const std::string& key, int value) {
+    return append_value(key, new ::parameter::value<int>(value));
+  }
+
+  std::size_t collection::append_key_value(const std::string& key, bool value) {
+    return append_value(key, new ::parameter::value<bool>(value));
+  }
+
+  std::size_t collection::append_key_value(const std::string& key, const std::string& value) {
+    return append_value(key, new ::parameter::value<std::string>(value));
+  }
+
+  void collection::set_current_point(const multi_index& point) {
+    if (point.size() > dimensions.get_dimension_number())
+      throw string_builder("the point has ")(point.size())(" dimensions, the collection has ")
+        (dimensions.get_dimension_number()).str();
+
+    multi_index selection(point);
+    selection.resize(dimensions.get_dimension_number(), 0);
+    for (std::size_t id(0); id < selection.size(); ++id)
+      if (selection[id] >= dimensions.get_size(id))
+        throw string_builder("value id ")(selection[id])(" out of the ")
+          (dimensions.get_size(id))(" values of the dimension ")(id).str();
+    dimensions.set_selection(selection);
+  }
+
+  std::string collection::get_enum_token(const std::string& key) const {
+    std::unique_ptr<const basic_value> decoded;
+    const basic_value* stored(find_current_value(key, decoded));
+    if (not stored)
+      throw_undefined_key(key);
+
+    PARAMETER_INSTRUMENT(stats, stats.record_get_enum_value(key));
+#ifdef PARAMETER_INSTRUMENTATION
+    const instrumentation::clock::time_point start(stats.begin_eval());
+#endif
+    const basic_value* tmp(stored->eval(*this));
+    PARAMETER_INSTRUMENT(stats, stats.end_eval(key, start));
+    const enum_value* v(dynamic_cast<const enum_value*>(tmp));
+    if (not v) {
+      delete tmp;
+      throw std::string("failed to get an enum value from the key '" + key
+                        + "' which has type " + stored->get_type());
+    }
+
+    const std::string token(v->get_token_value());
+    delete tmp;
+    return token;
+  }
+
+  template<typename element_type>
+  column_view<element_type> collection::get_column(const std::string& key) const {
+    const basic_value* v(get_basic_value(key));
+    const column_value<element_type>* c(dynamic_cast<const column_value<element_type>*>(v));
+    if (not c)
+      throw std::string("failed to get a "
+                        + std::string(basic_value::type_names[value_type_index<element_type>::value])
+                        + "-column from the key '" + key
+                        + "' which has type " + v->get_type());
+
+    column_view<element_type> view = { c->get_data(), c->get_size() };
+    return view;
+  }
+
+  template column_view<int> collection::get_column<int>(const std::string& key) const;
+  template column_view<double> collection::get_column<double>(const std::string& key) const;
+
+  /*
+   * Value of a key at any point of the collection. Plain values are
+   * read from a table indexed by the value id of the dimension of the
+   * key; values referring to other keys are resolved at the first point
+   * of each combination of the dimensions they depend on, and cached.
+   */
+  namespace {
+    // point at which a column_evaluator of the thread resolves the
+    // values of a collection, instead of its current point
+    thread_local const collection* evaluated_collection(nullptr);
+    thread_local const collection::multi_index* evaluated_selection(nullptr);
+  }
+
+  const collection::multi_index& collection::get_read_selection() const {
+    return evaluated_collection == this ? *evaluated_selection : dimensions.get_selection();
+  }
+
+  template<typename value_type>
+  class collection::column_evaluator {
+  public:
+    column_evaluator(const collection& c, const std::string& key)
+      : c(c), key(key), dimensions(c.dimensions), strides(dimensions.get_strides()),
+        previous_collection(evaluated_collection), previous_selection(evaluated_selection),
+        mv(nullptr), index_id(dimension_table::no_dimension), stride(1), size(1) {
+      mv = &c.find_defined_key(key);
+      c.materialize(*mv);
+      PARAMETER_INSTRUMENT(c.stats, c.stats.record_get_value(key));
+
+      index_id = mv->get_index_id();
+      if (index_id != dimension_table::no_dimension) {
+        stride = strides[index_id];
+        size = dimensions.get_size(index_id);
+      }
+
+      for (const auto v: mv->values) {
+        const value<value_type>* typed_v(dynamic_cast<const value<value_type>*>(v));
+        if (typed_v and not is_interpolated(v)) {
+          table.push_back(typed_v->get_value());
+        } else if (dynamic_cast<const value_ref*>(v) or is_interpolated(v)) {
+          table.clear();
+          break;
+        } else {
+          throw std::string("failed to get a "
+                            + std::string(basic_value::type_names[value_type_index<value_type>::value])
+                            + " from the key '" + key + "' which has type " + v->get_type());
+        }
+      }
+
+      if (table.empty()) {
+        dependencies = c.get_dependency_dimensions(key);
+
+        // the collection is read at the selection of the copy of its
+        // dimensions, for this thread only
+        evaluated_collection = &c;
+        evaluated_selection = &dimensions.get_selection();
+      }
+    }
+
+    ~column_evaluator() {
+      evaluated_collection = previous_collection;
+      evaluated_selection = previous_selection;
+    }
+
+    bool is_plain() const { return table.size(); }
+
+    value_type get(std::size_t i) {
+      if (is_plain())
+        return table[(i / stride) % size];
+
+      std::size_t combination(0), combination_stride(1);
+      for (const auto id: dependencies) {
+        combination += (i / strides[id]) % dimensions.get_size(id) * combination_stride;
+        combination_stride *= dimensions.get_size(id);
+      }
+
+      const auto cached(cache.find(combination));
+      if (cached != cache.end())
+        return cached->second;
+
+      // the value get_value gives at the point
+      dimensions.select(i);
+      const basic_value* stored(mv->get_value(dimensions.get_selection()));
+      const basic_value* v(stored->eval(c));
+      const value<value_type>* typed_v(dynamic_cast<const value<value_type>*>(v));
+      if (not typed_v) {
+        delete v;
+        throw std::string("failed to get a "
+                          + std::string(basic_value::type_names[value_type_index<value_type>::value])
+                          + " from the key '" + key + "' which has type " + stored->get_type());
+      }
+
+      const value_type result(typed_v->get_value());
+      delete v;
+      cache.emplace(combination, result);
+      return result;
+    }
+
+    /*
+     * Copy the values of the points [first, last) to out, by runs of
+     * points sharing a value.
+     */
+    void fill(std::size_t first, std::size_t last, value_type* out) {
+      if (not is_plain()) {
+        for (std::size_t i(first); i < last; ++i)
+          *out++ = get(i);
+        return;
+      }
+
+      std::size_t id((first / stride) % size);
+      if (stride == 1) {
+        // consecutive points take consecutive values
+        for (std::size_t i(first); i < last; ) {
+          const std::size_t n(std::min(size - id, last - i));
+          out = std::copy(table.begin() + id, table.begin() + id + n, out);
+          i += n;
+          id = 0;
+        }
+      } else {
+        for (std::size_t i(first); i < last; ) {
+          const std::size_t n(std::min(stride - i % stride, last - i));
+          out = std::fill_n(out, n, table[id]);
+          i += n;
+          id = (id + 1 == size ? 0 : id + 1);
+        }
+      }
+    }
+
+  private:
+    const collection& c;
+    const std::string key;
+
+    // copy of the dimensions of the collection, whose selection is
+    // changed to resolve dependent values
+    dimension_table dimensions;
+    const multi_index strides;
+    const collection* const previous_collection;
+    const multi_index* const previous_selection;
+
+    const multi_value* mv;
+    std::size_t index_id;
+    std::size_t stride;
+    std::size_t size;
+    std::vector<value_type> table;
+
+    std::vector<std::size_t> dependencies;
+    std::unordered_map<std::size_t, value_type> cache;
+
+  private:
+    static bool is_interpolated(const basic_value* v) {
+      const value<std::string>* str(dynamic_cast<const value<std::string>*>(v));
+      return str and get_interpolated_keys(str->get_value()).size();
+    }
+  };
+
+  template<typename value_type>
+  void collection::evaluate_column(const std::string& key, std::size_t first, std::size_t last,
+                                   value_type* out) const {
+    if (first > last or last > get_collection_size())
+      throw string_builder("the range [")(first)(", ")(last)(") is out of the ")
+        (get_collection_size())(" points of the collection").str();
+
+    column_evaluator<value_type> evaluator(*this, key);
+    evaluator.fill(first, last, out);
+  }
+
+  template<typename value_type>
+  void collection::evaluate_column(const std::string& key, const std::vector<std::size_t>& indices,
+                                   value_type* out) const {
+    const std::size_t point_number(get_collection_size());
+    for (const auto i: indices)
+      if (i >= point_number)
+        throw string_builder("the point ")(i)(" is out of the ")
+          (point_number)(" points of the collection").str();
+
+    column_evaluator<value_type> evaluator(*this, key);
+    for (const auto i: indices)
+      *out++ = evaluator.get(i);
+  }
+
+  const basic_value* collection::evaluate_at(const std::string& key, std::size_t i) const {
+    if (i >= get_collection_size())
+      throw string_builder("the point ")(i)(" is out of the ")
+        (get_collection_size())(" points of the collection").str();
+
+    dimension_table point(dimensions);
+    point.select(i);
+
+    // the collection is read at the point, for this thread only
+    struct selection_guard {
+      const collection* const previous_collection;
+      const multi_index* const previous_selection;
+
+      selection_guard(const collection* c, const multi_index* selection)
+        : previous_collection(evaluated_collection), previous_selection(evaluated_selection) {
+        evaluated_collection = c;
+        evaluated_selection = selection;
+      }
+
+      ~selection_guard() {
+        evaluated_collection = previous_collection;
+        evaluated_selection = previous_selection;
+      }
+    } guard(this, &point.get_selection());
+
+    const multi_value& mv(find_defined_key(key));
+    materialize(mv);
+    PARAMETER_INSTRUMENT(stats, stats.record_get_basic_value(key));
+    return mv.get_value(point.get_selection())->eval(*this);
+  }
+
+  std::vector<std::size_t> collection::get_dependency_dimensions(const std::string& key) const {
+    std::set<std::string> visited;
+    std::vector<std::size_t> ids;
+    add_dependency_dimensions(key, visited, ids);
+    return ids;
+  }
+
+  void collection::add_dependency_dimensions(const std::string& key, std::set<std::string>& visited,
+                                             std::vector<std::size_t>& ids) const {
+    if (not visited.insert(key).second)
+      return;
+
+    const multi_value& mv(find_defined_key(key));
+    materialize(mv);
+    const std::size_t id(mv.get_index_id());
+    if (id != dimension_table::no_dimension and std::find(ids.begin(), ids.end(), id) == ids.end())
+      ids.push_back(id);
+
+    for (const auto v: mv.values)
+      if (const value_ref* r = dynamic_cast<const value_ref*>(v))
+        add_dependency_dimensions(r->get_key(), visited, ids);
+      else if (const value<std::string>* str = dynamic_cast<const value<std::string>*>(v))
+        for (const auto& interpolated: get_interpolated_keys(str->get_value()))
+          add_dependency_dimensions(interpolated, visited, ids);
+  }
+
+  template void collection::evaluate_column<int>(const std::string& key, std::size_t first, std::size_t last,
+                                                 int* out) const;
+  template void collection::evaluate_column<bool>(const std::string& key, std::size_t first, std::size_t last,
+                                                  bool* out) const;
+  template void collection::evaluate_column<std::string>(const std::string& key, std::size_t first, std::size_t last,
+                                                         std::string* out) const;
+  template void collection::evaluate_column<double>(const std::string& key, std::size_t first, std::size_t last,
+                                                    double* out) const;
+  template void collection::evaluate_column<int>(const std::string& key, const std::vector<std::size_t>& indices,
+                                                 int* out) const;
+  template void collection::evaluate_column<bool>(const std::string& key, const std::vector<std::size_t>& indices,
+                                                  bool* out) const;
+  template void collection::evaluate_column<std::string>(const std::string& key, const std::vector<std::size_t>& indices,
+                                                         std::string* out) const;
+  template void collection::evaluate_column<double>(const std::string& key, const std::vector<std::size_t>& indices,
+                                                    double* out) const;
+
+  const basic_value* collection::get_basic_value(const std::string& key) const {
+    const multi_value& mv(find_defined_key(key));
+
+    materialize(mv);
+    PARAMETER_INSTRUMENT(stats, stats.record_get_basic_value(key));
+    return mv.get_value(get_read_selection());
+  }
+
+  const basic_value* collection::get_resolved_value(const std::string& key) const {
+    const std::size_t key_number(key_value.size() + (shared ? shared->get_header().key_number : 0));
+
+    // the strings interpolated by eval resolve other keys in turn, a
+    // key met again while it is resolved is a loop
+    static thread_local std::vector<std::pair<const collection*, std::string> > resolving;
+    const std::pair<const collection*, std::string> current(this, key);
+    if (std::find(resolving.begin(), resolving.end(), current) != resolving.end())
+      throw std::string("circular reference from the key '" + key + "'");
+    struct resolving_guard {
+      resolving_guard(const std::pair<const collection*, std::string>& k) { resolving.push_back(k); }
+      ~resolving_guard() { resolving.pop_back(); }
+    } guard(current);
+
+    std::unique_ptr<const basic_value> decoded;
+    std::string current_key(key);
+    std::size_t depth(0);
+    while (true) {
+      const basic_value* v(find_current_value(current_key, decoded));
+      if (not v)
+        throw_undefined_key(current_key);
+      PARAMETER_INSTRUMENT(stats, stats.record_get_basic_value(current_key));
+
+      const value_ref* r(dynamic_cast<const value_ref*>(v));
+      if (not r)
+        return v->eval(*this);
+      if (++depth > key_number)
+        throw std::string("circular reference from the key '" + key + "'");
+      current_key = r->get_key();
+    }
+  }
+
+  template<typename function_type>
+  void collection::for_each_key_value(function_type f) const {
+    auto kv(key_value.begin());
+    const std::size_t shared_key_number(shared ? shared->get_header().key_number : 0);
+    for (std::size_t i(0); i < shared_key_number; ++i) {
+      const shared_key& k(shared->get_key(i));
+      const std::string name(shared->get_key_name(k));
+      for (; kv != key_value.end() and kv->first < name; ++kv)
+        f(kv->first, kv->second);
+
+      // the keys copied or redefined in the collection hide the segment
+      if (kv == key_value.end() or kv->first != name)
+        f(name, decode_shared_key(k));
+    }
+    for (; kv != key_value.end(); ++kv)
+      f(kv->first, kv->second);
+  }
+
+  std::vector<std::string> collection::get_keys() const {
+    return get_keys_with_prefix(std::string());
+  }
+
+  std::vector<std::string> collection::get_keys_with_prefix(const std::string& prefix) const {
+    std::vector<std::string> keys;
+    for (auto kv(key_value.lower_bound(prefix));
+         kv != key_value.end() and kv->first.compare(0, prefix.size(), prefix) == 0;
+         ++kv)
+      keys.push_back(kv->first);
+
+    if (shared) {
+      // both tables are sorted, the keys of the segment which are not
+      // in the collection are merged in
+      const std::size_t local_key_number(keys.size());
+      for (std::size_t i(shared->lower_bound(prefix)); i < shared->get_header().key_number; ++i) {
+        const shared_key& k(shared->get_key(i));
+        if (not shared->has_prefix(k, prefix))
+          break;
+        std::string name(shared->get_key_name(k));
+        if (key_value.find(name) == key_value.end())
+          keys.push_back(std::move(name));
+      }
+      std::inplace_merge(keys.begin(), keys.begin() + local_key_number, keys.end());
+    }
+    return keys;
+  }
+
+  bool collection::contains(const std::string& key) const {
+    return key_value.find(key) != key_value.end() or (shared and shared->find(key));
+  }
+
+  std::vector<std::string> collection::get_keys_matching(const std::string& pattern) const {
+    std::vector<std::string> keys;
+    for (const auto& key: get_keys_with_prefix(pattern.substr(0, pattern.find_first_of("*?"))))
+      if (match_glob(pattern, key))
+        keys.push_back(key);
+    return keys;
+  }
+
+  const collection::multi_value& collection::get_multi_value(const std::string& key) const {
+    const multi_value* mv(find_key(key));
+    if (not mv)
+      throw std::string("the key '" + key + "' is not found in the parameter collection");
+    materialize(*mv);
+    return *mv;
+  }
+
+  void collection::check_references(std::vector<diagnostic>& d) const {
+    for_each_key_value([&](const std::string& key, const multi_value& mv) {
+      materialize(mv);
+      for (const auto v: mv.values) {
+        std::vector<std::string> referenced_keys;
+
+        if (const value_ref* r = dynamic_cast<const value_ref*>(v))
+          referenced_keys.push_back(r->get_key());
+        else if (const value<std::string>* str = dynamic_cast<const value<std::string>*>(v))
+          referenced_keys = get_interpolated_keys(str->get_value());
+
+        for (const auto& k: referenced_keys)
+          if (not contains(k)) {
+            std::string message(string_builder("the key '")(key)
+                                ("' refers to the undefined key '")(k)("'"));
+            std::string suggestion;
+            if (make_suggestion(k, suggestion))
+              message += ", did you mean '" + suggestion + "'?";
+            d.push_back(diagnostic(diagnostic::severity::error,
+                                   message + get_definition_location(key)));
+          }
+      }
+    });
+  }
+
+  std::string collection::get_definition_location(const std::string& key) const {
+    const auto c(definition_coordinates.find(key));
+    return c == definition_coordinates.end() ? std::string() : " (defined at " + c->second + ")";
+  }
+
+  std::vector<std::string> collection::get_unread_keys() const {
+    if (not stats.is_enabled())
+      throw std::string("the instrumentation is not enabled, the reads of the keys are not recorded");
+
+    std::vector<std::string> unread;
+    for (const auto& key: get_keys())
+      if (not stats.is_read(key))
+        unread.push_back(key);
+    return unread;
+  }
+
+  void collection::print_unread_keys(std::ostream& stream) const {
+    for (const auto& key: get_unread_keys())
+      stream << "warning: key '" << key << "' is defined but never read" << std::endl;
+  }
+
+  memory_usage collection::get_memory_usage() const {
+    memory_usage usage;
+    for (const auto& kv: key_value) {
+      const std::size_t key_footprint(sizeof(std::map<std::string, multi_value>::value_type)
+                                      + 4 * sizeof(void*)
+                                      + get_dynamic_footprint(kv.first)
+                                      + kv.second.get_memory_footprint());
+      usage.by_key[kv.first] = key_footprint;
+      usage.total += key_footprint;
+
+      for (const auto v: kv.second.values)
+        usage.by_kind[v->get_type()] += v->get_memory_footprint();
+    }
+
+    const std::size_t index_footprint(dimensions.get_memory_footprint());
+    usage.by_kind["index"] += index_footprint;
+    usage.total += sizeof(*this) + index_footprint;
+
+    return usage;
+  }
+
+  void collection::clear() {
+    key_value.clear();
+    decoded_keys.keys.clear();
+    dimensions.clear();
+    dimension_costs.clear();
+    shared.reset();
+    shared_dimension_ids.clear();
+  }
+
+  void collection::read_shared(const std::string& filename, const std::string& segment_name) {
+    std::unique_ptr<shared_segment> segment(shared_segment::create(segment_name));
+    if (not segment) {
+      attach_shared(segment_name);
+      if (not shared->is_read_from(filename)) {
+        clear();
+        throw std::string("the shared memory segment '" + segment_name + "' does not hold the collection of the file '"
+                          + filename + "' in its current state, unlink the segment to read the file again");
+      }
+      return;
+    }
+
+    try {
+      read_from_file(filename);
+      segment->publish(build_shared_image(filename));
+    } catch (...) {
+      segment->fail();
+      throw;
+    }
+  }
+
+  void collection::publish_shared(const std::string& segment_name) const {
+    std::unique_ptr<shared_segment> segment(shared_segment::create(segment_name));
+    if (not segment)
+      throw std::string("the shared memory segment '" + segment_name + "' already exists");
+
+    try {
+      segment->publish(build_shared_image(std::string()));
+    } catch (...) {
+      segment->fail();
+      throw;
+    }
+  }
+
+  void collection::attach_shared(const std::string& segment_name) {
+    clear();
+    shared = std::make_shared<const shared_image>(shared_segment::attach(segment_name));
+
+    const shared_header& h(shared->get_header());
+    for (std::size_t id(0); id < h.dimension_number; ++id) {
+      const shared_dimension& d(shared->get_dimension(id));
+      shared_dimension_ids.push_back(dimensions.add(d.size, d.key_number));
+    }
+
+    // the costs are kept by key, as set_dimension_cost does
+    for (std::size_t i(0); i < h.key_number; ++i) {
+      const shared_key& k(shared->get_key(i));
+      if (k.index_id != shared_no_dimension and shared->get_dimension(k.index_id).cost != 0.)
+        dimension_costs[shared->get_key_name(k)] = shared->get_dimension(k.index_id).cost;
+    }
+    if (dimension_costs.size())
+      update_dimension_costs();
+  }
+
+  void collection::unlink_shared(const std::string& segment_name) {
+    shared_segment::unlink(segment_name);
+  }
+
+  void collection::print_key_values(std::ostream& stream) const {
+    for_each_key_value([&](const std::string& key, const multi_value& mv) {
+      materialize(mv);
+      stream << mv.get_type(dimensions.get_selection()) << " " << key
+        << " = "
+        << mv.print_value(dimensions.get_selection()) << std::endl;
+    });
+  }
+
+  void collection::record_definition(const key_value_definition& def) {
+    if (diagnostics)
+      definition_coordinates[def.key] = def.coordinates;
+  }
+
+  std::size_t collection::levenshtein_distance(const std::string& s1, const std::string& s2) const {
+    std::vector<int>
+      v0(s2.size() + 1),
+      v1(s2.size() + 1);
+    
+    std::iota(v0.begin(), v0.end(), 0);
+
+    for (std::size_t i(0); i < s1.size(); ++i) {
+      v0[0] = i + 1;
+
+      int substitution_cost(0);
+      for (std::size_t j(0); j < s2.size(); ++j) {
+        if (s1[i] == s2[j])
+          substitution_cost = 0;
+        else
+          substitution_cost = 1;
+
+        v1[j + 1] = std::min({v1[j] + 1,
+                              v0[j + 1] + 1,
+                              v0[j] + substitution_cost});
+      }
+      std::swap(v0, v1);
+    }
+    return v0.back();
+  }
+
+  bool collection::make_suggestion(const std::string& key, std::string& suggestion) const {
+    const std::vector<std::string> keys(get_keys());
+    const auto closest_key(
+      std::min_element(keys.cbegin(),
+                       keys.cend(),
+                       [&](const std::string& key1, const std::string& key2) {
+                         return levenshtein_distance(key1, key) < levenshtein_distance(key2, key);
+                       }));
+    
+    if (closest_key != keys.end()) {
+      suggestion = *closest_key;
+      return true;
+    } else {
+      return false;
+    }
+  }
+
+  void collection::set_key_value_group(std::vector<key_value_definition>&& defs) {
+    if (defs.size()) {
+      std::size_t set_size(defs.front().mv.get_value_number());
+      for (const auto& def: defs)
+        if (def.mv.get_value_number() != set_size) {
+          report_error(string_builder("group definition has incoherent element number in definition near ")(def.coordinates)(".").str());
+          return;
+        }
+
+      const std::size_t index_id(set_size > 1 ?
+                                 dimensions.add(set_size, defs.size()) :
+                                 dimension_table::no_dimension);
+      for (auto& def: defs) {
+        using map_type = std::map<std::string, multi_value>;
+        using map_iterator_type = map_type::iterator;
+
+        copy_shared_key(def.key);
+        map_iterator_type kv(key_value.find(def.key));
+        if (kv == key_value.end()) {
+          (key_value[def.key] = std::move(def.mv)).set_index_id(index_id);
+        
+          if (is_defined_by_variant_base(def.key)) {
+            if (not def.is_overriding)
+              report_warning(string_builder("redefinition of key '")(def.key)
+                             ("' at ")(def.coordinates)(". If it is the intended action, ")
+                             ("prefix the definition by the 'override' keyword.").str());
+          } else if (def.is_overriding)
+            report_error(string_builder("attempt to redefine key '")(def.key)("' which is not (yet) defined at ")(def.coordinates)(".").str());
+
+        } else {
+          dimensions.release(kv->second.get_index_id());
+          kv->second = std::move(def.mv);
+          kv->second.set_index_id(index_id);
+
+          if (not def.is_overriding)
+            report_warning(string_builder("redefinition of key '")(def.key)
+                           ("' at ")(def.coordinates)(". If it is the intended action, ")
+                           ("prefix the definition by the 'override' keyword.").str());
+        }
+        record_definition(def);
+      }
+    }
+  }
+
+  bool collection::set_key_value(const std::string& key, basic_value* v) {
+    return set_key_value(key, multi_value(dimension_table::no_dimension, v));
+  }
+
+  bool collection::set_key_value(const std::string& key, multi_value&& mv) {
+    using map_type = std::map<std::string, multi_value>;
+    using map_iterator_type = map_type::iterator;
+
+    copy_shared_key(key);
+    map_iterator_type kv(key_value.lower_bound(key));
+    if (kv == key_value.end() or kv->first != key) {
+      const std::size_t index_id(mv.get_value_number() > 1 ?
+                                 dimensions.add(mv.get_value_number(), 1) :
+                                 dimension_table::no_dimension);
+      key_value.emplace_hint(kv, key, std::move(mv))->second.set_index_id(index_id);
+
+      return false;
+    } else {
+      // a key alone in its dimension keeps its place in the sweep
+      std::size_t index_id(kv->second.get_index_id());
+      if (index_id != dimension_table::no_dimension
+          and dimensions.get_key_number(index_id) == 1
+          and mv.get_value_number() > 1) {
+        dimensions.resize(index_id, mv.get_value_number());
+      } else {
+        dimensions.release(index_id);
+        index_id = (mv.get_value_number() > 1 ?
+                    dimensions.add(mv.get_value_number(), 1) :
+                    dimension_table::no_dimension);
+      }
+
+      kv->second = std::move(mv);
+      kv->second.set_index_id(index_id);
+
+      return true;
+    }
+  }
+
+  void collection::compact_dimensions() {
+    if (dimensions.has_dead_dimensions()) {
+      const std::vector<std::size_t> remap(dimensions.compact());
+      for (auto& kv: key_value)
+        if (kv.second.get_index_id() != dimension_table::no_dimension)
+          kv.second.set_index_id(remap[kv.second.get_index_id()]);
+      for (auto& kv: decoded_keys.keys)
+        if (kv.second.get_index_id() != dimension_table::no_dimension)
+          kv.second.set_index_id(remap[kv.second.get_index_id()]);
+      for (auto& id: shared_dimension_ids)
+        if (id != dimension_table::no_dimension)
+          id = remap[id];
+    }
+
+    if (dimension_costs.size())
+      update_dimension_costs();
+  }
+
+  void collection::update_dimension_costs() {
+    dimensions.reset_costs();
+    for (const auto& c: dimension_costs) {
+      const multi_value* mv(find_key(c.first));
+      if (mv and mv->get_index_id() != dimension_table::no_dimension)
+        dimensions.set_cost(mv->get_index_id(), c.second);
+    }
+  }
+
+  std::vector<std::size_t> collection::get_projection_dimensions(const std::vector<std::string>& keys) const {
+    std::vector<std::size_t> ids;
+    for (const auto& key: keys) {
+      const std::size_t id(get_multi_value(key).get_index_id());
+      if (id != dimension_table::no_dimension)
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+  }
+
+  template<typename value_type>
+  value_type collection::read_value(const std::string& key, const basic_value* stored) const {
+    PARAMETER_INSTRUMENT(stats, stats.record_get_value(key));
+#ifdef PARAMETER_INSTRUMENTATION
+    const instrumentation::clock::time_point start(stats.begin_eval());
+#endif
+    const basic_value* tmp(stored->eval(*this));
+    PARAMETER_INSTRUMENT(stats, stats.end_eval(key, start));
+    const value<value_type>* v(dynamic_cast<const value<value_type>*>(tmp));
+    if (not v) {
+      delete tmp;
+      throw std::string("failed to get a "
+                        + std::string(basic_value::type_names[value_type_index<value_type>::value])
+                        + " from the key '" + key
+                        + "' which has type " + stored->get_type());
+    }
+
+    value_type result(v->get_value());
+    delete tmp;
+    return result;
+  }
+
+  template<typename value_type>
+  bool collection::lookup_value(const std::string& key, value_type& result) const {
+    std::unique_ptr<const basic_value> decoded;
+    const basic_value* stored(find_current_value(key, decoded));
+    if (not stored)
+      return false;
+
+    result = read_value<value_type>(key, stored);
+    return true;
+  }
+
+  template bool collection::lookup_value<int>(const std::string& key, int& result) const;
+  template bool collection::lookup_value<bool>(const std::string& key, bool& result) const;
+  template bool collection::lookup_value<std::string>(const std::string& key, std::string& result) const;
+  template bool collection::lookup_value<double>(const std::string& key, double& result) const;
+
+  const basic_value* collection::find_current_value(const std::string& key,
+                                                    std::unique_ptr<const basic_value>& decoded) const {
+    const auto kv(key_value.find(key));
+    if (kv != key_value.end()) {
+      materialize(kv->second);
+      return kv->second.get_value(get_read_selection());
+    }
+
+    const shared_key* k(shared ? shared->find(key) : nullptr);
+    if (not k)
+      return nullptr;
+
+    const std::size_t i(k->index_id == shared_no_dimension ?
+                        0 : get_read_selection()[shared_dimension_ids[k->index_id]]);
+    decoded.reset(decode_shared_value(k->first_value + i));
+    return decoded.get();
+  }
+
+  void collection::throw_undefined_key(const std::string& key) const {
+    std::string suggestion;
+    if (make_suggestion(key, suggestion)) {
+        throw std::string("the key '"
+                          + key
+                          + "' is not found in the parameter collection, did you mean '"
+                          + suggestion
+                          + "'?");
+    } else {
+        throw std::string("the key '"
+                          + key
+                          + "' is not found in the parameter collection");
+    }
+  }
+
+  const collection::multi_value& collection::find_defined_key(const std::string& key) const {
+    const multi_value* mv(find_key(key));
+    if (not mv)
+      throw_undefined_key(key);
+    return *mv;
+  }
+
+  const collection::multi_value* collection::find_key(const std::string& key) const {
+    const auto kv(key_value.find(key));
+    if (kv != key_value.end())
+      return &kv->second;
+
+    const shared_key* k(shared ? shared->find(key) : nullptr);
+    if (not k)
+      return nullptr;
+
+    // the nodes of the map stay in place, the references returned
+    // earlier remain valid
+    std::lock_guard<std::mutex> lock(decoded_keys.m);
+    auto decoded(decoded_keys.keys.find(key));
+    if (decoded == decoded_keys.keys.end())
+      decoded = decoded_keys.keys.emplace(key, decode_shared_key(*k)).first;
+    return &decoded->second;
+  }
+
+  void collection::copy_shared_key(const std::string& key) {
+    if (not shared or key_value.count(key))
+      return;
+
+    const shared_key* k(shared->find(key));
+    if (not k)
+      return;
+
+    std::lock_guard<std::mutex> lock(decoded_keys.m);
+    const auto decoded(decoded_keys.keys.find(key));
+    if (decoded == decoded_keys.keys.end()) {
+      key_value.emplace(key, decode_shared_key(*k));
+    } else {
+      key_value.emplace(key, std::move(decoded->second));
+      decoded_keys.keys.erase(decoded);
+    }
+  }
+
+  basic_value* collection::decode_shared_value(std::size_t i) const {
+    const shared_value& v(shared->get_value(i));
+    switch (v.type) {
+    case shared_value::integer: return new value<int>(v.integer_value);
+    case shared_value::real: return new value<double>(v.real_value);
+    case shared_value::boolean: return new value<bool>(v.integer_value != 0);
+    case shared_value::string: return new value<std::string>(shared->get_text(v));
+    case shared_value::enum_item: return new enum_value(shared->get_text(v));
+    case shared_value::reference: return new value_ref(shared->get_text(v));
+    }
+    throw string_builder("unknown value type ")(v.type)(" in the shared memory segment").str();
+  }
+
+  collection::multi_value collection::decode_shared_key(const shared_key& k) const {
+    multi_value mv;
+    mv.set_index_id(k.index_id == shared_no_dimension ?
+                    dimension_table::no_dimension :
+                    shared_dimension_ids[k.index_id]);
+    for (std::size_t i(k.first_value); i < k.first_value + k.value_number; ++i)
+      mv.append_value(decode_shared_value(i));
+    return mv;
+  }
+
+  bool collection::match_glob(const std::string& pattern, const std::string& str) {
+    std::size_t p(0), s(0);
+    std::size_t star(std::string::npos), resume(0);
+    while (s < str.size()) {
+      if (p < pattern.size() and (pattern[p] == '?' or pattern[p] == str[s])) {
+        p += 1;
+        s += 1;
+      } else if (p < pattern.size() and pattern[p] == '*') {
+        star = p++;
+        resume = s;
+      } else if (star != std::string::npos) {
+        p = star + 1;
+        s = ++resume;
+      } else {
+        return false;
+      }
+    }
+    while (p < pattern.size() and pattern[p] == '*')
+      p += 1;
+    return p == pattern.size();
+  }
+
+  std::string collection::build_shared_image(const std::string& source_filename) const {
+    const std::size_t dimension_number(dimensions.get_dimension_number());
+    std::size_t key_number(0), value_number(0);
+    for_each_key_value([&](const std::string&, const multi_value& mv) {
+      key_number += 1;
+      value_number += mv.get_value_number();
+    });
+
+    shared_header h;
+    std::memset(&h, 0, sizeof(h));
+    std::memcpy(h.magic, shared_segment::magic(), sizeof(h.magic));
+    h.state = shared_header::loading;
+    h.dimension_number = dimension_number;
+    h.dimension_offset = sizeof(shared_header);
+    h.key_number = key_number;
+    h.key_offset = h.dimension_offset + dimension_number * sizeof(shared_dimension);
+    h.value_number = value_number;
+    h.value_offset = h.key_offset + key_number * sizeof(shared_key);
+    const std::size_t text_offset(h.value_offset + value_number * sizeof(shared_value));
+
+    std::vector<shared_dimension> dimension_records(dimension_number);
+    for (std::size_t id(0); id < dimension_number; ++id) {
+      dimension_records[id].size = dimensions.get_size(id);
+      dimension_records[id].key_number = dimensions.get_key_number(id);
+      dimension_records[id].cost = dimensions.get_cost(id);
+    }
+
+    std::vector<shared_key> key_records;
+    std::vector<shared_value> value_records;
+    std::string text;
+    const auto add_text = [&text, text_offset](const std::string& str, std::uint64_t& offset, std::uint64_t& size) {
+      offset = text_offset + text.size();
+      size = str.size();
+      text += str;
+    };
+
+    if (source_filename.size()) {
+      add_text(source_filename, h.source_name_offset, h.source_name_size);
+      shared_segment::get_file_identity(source_filename, h.source_file_size, h.source_modification_time);
+    }
+
+    for_each_key_value([&](const std::string& key, const multi_value& mv) {
+      shared_key k;
+      add_text(key, k.name_offset, k.name_size);
+      k.index_id = mv.get_index_id() == dimension_table::no_dimension ?
+        shared_no_dimension : mv.get_index_id();
+      k.first_value = value_records.size();
+      k.value_number = mv.get_value_number();
+      key_records.push_back(k);
+
+      // lazy values are converted for the segment only
+      const bool is_lazy(mv.is_lazy.load());
+      const multi_value converted(is_lazy ? mv.clone() : multi_value());
+      converted.materialize();
+      for (const auto m: is_lazy ? converted.values : mv.values) {
+        shared_value s;
+        std::memset(&s, 0, sizeof(s));
+        if (const value<int>* i = dynamic_cast<const value<int>*>(m)) {
+          s.type = shared_value::integer;
+          s.integer_value = i->get_value();
+        } else if (const value<double>* d = dynamic_cast<const value<double>*>(m)) {
+          s.type = shared_value::real;
+          s.real_value = d->get_value();
+        } else if (const value<bool>* b = dynamic_cast<const value<bool>*>(m)) {
+          s.type = shared_value::boolean;
+          s.integer_value = b->get_value();
+        } else if (const value<std::string>* str = dynamic_cast<const value<std::string>*>(m)) {
+          s.type = shared_value::string;
+          add_text(str->get_value(), s.text.offset, s.text.size);
+        } else if (const enum_value* e = dynamic_cast<const enum_value*>(m)) {
+          s.type = shared_value::enum_item;
+          add_text(e->get_token_value(), s.text.offset, s.text.size);
+        } else if (const value_ref* r = dynamic_cast<const value_ref*>(m)) {
+          s.type = shared_value::reference;
+          add_text(r->get_key(), s.text.offset, s.text.size);
+        } else {
+          throw std::string("the key '" + key + "' has a value of type "
+                            + m->get_type() + " which cannot be shared");
+        }
+        value_records.push_back(s);
+      }
+    });
+
+    h.size = text_offset + text.size();
+    std::string image(reinterpret_cast<const char*>(&h), sizeof(h));
+    image.append(reinterpret_cast<const char*>(dimension_records.data()),
+                 dimension_records.size() * sizeof(shared_dimension));
+    image.append(reinterpret_cast<const char*>(key_records.data()),
+                 key_records.size() * sizeof(shared_key));
+    image.append(reinterpret_cast<const char*>(value_records.data()),
+                 value_records.size() * sizeof(shared_value));
+    image += text;
+    return image;
+  }
+
+  std::size_t collection::append_value(const std::string& key, basic_value* v) {
+    using map_type = std::map<std::string, multi_value>;
+    using map_iterator_type = map_type::iterator;
+
+    copy_shared_key(key);
+    map_iterator_type kv(key_value.find(key));
+    if (kv == key_value.end()) {
+      delete v;
+      throw std::string("trying to append a value to an undefined key '") + key + "'";
+    } else {
+      materialize(kv->second);
+      for (const auto w: kv->second.values)
+        if (w->get_type() != v->get_type()) {
+          const std::string message("trying to append a value of type " + v->get_type() + " to the key '" + key
+                                    + "' which has values of type " + w->get_type());
+          delete v;
+          throw message;
+        }
+
+      const std::size_t index_id(kv->second.get_index_id());
+      if (index_id == dimension_table::no_dimension) {
+        kv->second.append_value(v);
+        kv->second.set_index_id(dimensions.add(2, 1));
+        if (dimension_costs.count(key))
+          update_dimension_costs();
+      } else if (dimensions.get_key_number(index_id) == 1) {
+        kv->second.append_value(v);
+        dimensions.grow(index_id);
+      } else {
+        delete v;
+        throw std::string("trying to append a value to the key '") + key
+          + "' which is part of a group";
+      }
+      return kv->second.get_value_number() - 1;
+    }
+  }
+
+  void collection::set_global_definition(key_value_definition&& def) {
+    const bool redefinition(set_key_value(def.key, std::move(def.mv))
+                            or is_defined_by_variant_base(def.key));
+    record_definition(def);
+
+    if (def.is_overriding and not redefinition)
+      report_error(string_builder("attempt to redefine key '")(def.key)("' which is not (yet) defined at ")(def.coordinates)(".").str());
+
+    if (redefinition and not def.is_overriding)
+      report_warning(string_builder("redefinition of key '")(def.key)
+                     ("' at ")(def.coordinates)(". If it is the intended action, ")
+                     ("prefix the definition by the 'override' keyword.").str());
+  }
 
 }
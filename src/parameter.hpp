@@ -1,127 +1,21 @@
 #ifndef PARAMETER_H
 #define PARAMETER_H
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
-#include <numeric>
+#include <string>
+#include <vector>
 
-#include <unistd.h>
-
-#include <spikes/meta.hpp>
-#include <spikes/array.hpp>
-#include <lexer/lexer.hpp>
+#include "instrumentation.hpp"
 
 namespace parameter {
 
-  class resource_locator {
-  public:
-    resource_locator(const std::string& path)
-      : separator('/'), is_absolute(false) {
-      if (path[0] == '/')
-        is_absolute = true;
-      components = split(path, separator);
-    }
-    
-    std::string resource_name() const { return components.back(); }
-    
-    resource_locator resource_path() const {
-      if (components.size() == 1)
-        return resource_locator("./");
-      else
-        return resource_locator(components.begin(), components.end() - 1, is_absolute);
-    }
-    
-    std::string to_string() const {
-      std::string str;
-
-      if (is_absolute) str += separator;
-
-      for (std::size_t i(0); i < components.size() - 1; ++i) {
-        str += components[i];
-        str += '/';
-      }
-      str += components.back();
-
-      return str;
-    }
-
-  private:
-    std::vector<std::string> components;
-    char separator;
-    bool is_absolute;
-
-  private:
-    resource_locator(std::vector<std::string>::const_iterator begin,
-                     std::vector<std::string>::const_iterator end,
-                     bool is_absolute)
-      : components(begin, end), separator('/'), is_absolute(is_absolute) {}
-
-    static std::vector<std::string> split(const std::string& str, char separator) {
-      std::vector<std::string> components;
-      std::string c;
-      
-      std::size_t i(0);
-      while (i < str.size()) {
-        if (str[i] == separator) {
-          if (c.size())
-            components.push_back(c);
-          c.clear();
-          i += 1;
-        } else {
-          c += str[i];
-          i += 1;
-        }
-      }
-      
-      if (c.size())
-        components.push_back(c);
-
-      return components;
-    }
-  };
-
-  inline
-  resource_locator get_current_working_directory() {
-    std::vector<char> buffer(255);
-    char* b(&buffer[0]);
-    while (getcwd(b, buffer.size()) == nullptr)
-      buffer.resize(buffer.size() * 2);
-    return resource_locator(std::string(b));
-  }
-
-  inline
-  void change_directory(resource_locator l) {
-    std::string path(l.to_string());
-    if (path != ".") {
-
-      int res(chdir(path.c_str()));
-
-      if (res != 0) {
-        switch (errno) {
-        case EACCES:
-          throw std::string("chdir error EACCES");
-        case EFAULT:
-          throw std::string("chdir error EFAULT");
-        case EIO:
-          throw std::string("chdir error EIO");
-        case ELOOP:
-          throw std::string("chdir error ELOOP");
-        case ENAMETOOLONG:
-          throw std::string("chdir error ENAMETOOLONG");
-        case ENOENT:
-          throw std::string("chdir error ENOENT");
-        case ENOMEM:
-          throw std::string("chdir error ENOMEM");
-        case ENOTDIR:
-          throw std::string("chdir error ENOTDIR");
-        default:
-          throw std::string("chdir unknown error");
-        }
-      }
-    }
-  }
-  
   class string_builder {
   public:
     template<typename value_type>
@@ -144,53 +38,40 @@ namespace parameter {
   private:
     std::ostringstream oss;
   };
-  
-  template<typename token_type>
-  class token_source {
-  public:
-    token_source(regex_lexer<token_type>* l)
-      : lex(l), current(lex->get()) {}
 
-    ~token_source() { delete current; }
-    
-    token_type* get() {
-      token_type* c(current);
-      current = lex->get();
-      return c;
-    }
-    
-    token_type* peek() {
-      return current;
-    }
+  class collection;
 
-  private:
-    regex_lexer<token_type>* lex;
-    token_type* current;
-  };
+  struct diagnostic {
+    enum class severity { error, warning };
 
-  
-  enum class symbol {
-    eoi, equal, comma, value,
-    enum_item,
-    string,
-    integer,
-    real,
-    boolean,
-    import,
-    lbracket, rbracket,
-    override_keyword,
-    key
+    severity level;
+    std::string message;
+
+    diagnostic(severity level, const std::string& message)
+      : level(level), message(message) {}
+
+    bool is_error() const { return level == severity::error; }
   };
 
-  using symbol_type = symbol;
-  using token_type = token<symbol_type>;
+  inline
+  std::ostream& operator<<(std::ostream& stream, const diagnostic& d) {
+    return stream << (d.is_error() ? "error: " : "warning: ") << d.message;
+  }
 
-  
-  std::ostream& operator<<(std::ostream& stream, symbol s);
-  regex_lexer<token_type> build_lexer();
+  std::vector<std::string> get_interpolated_keys(const std::string& str);
+
+  /*
+   * Position of the value types of the collection in
+   * basic_value::type_names, -1 for the other types.
+   */
+  template<typename value_type>
+  struct value_type_index { static constexpr int value = -1; };
+
+  template<> struct value_type_index<int> { static constexpr int value = 0; };
+  template<> struct value_type_index<bool> { static constexpr int value = 1; };
+  template<> struct value_type_index<std::string> { static constexpr int value = 2; };
+  template<> struct value_type_index<double> { static constexpr int value = 3; };
 
-  class collection;
-  
   class basic_value {
   public:
     virtual ~basic_value() {}
@@ -198,8 +79,8 @@ namespace parameter {
     virtual std::string print_value() const = 0;
     virtual basic_value* clone() const = 0;
     virtual const basic_value* eval(const collection& c) const = 0;
-    
-    using value_type_list = type_list<int, bool, std::string, double>;
+    virtual std::size_t get_memory_footprint() const = 0;
+
     static constexpr const char* type_names[4] = {"integer", "boolean", "string", "real"};
   };
 
@@ -223,6 +104,10 @@ namespace parameter {
       return clone();
     }
 
+    virtual std::size_t get_memory_footprint() const {
+      return sizeof(*this) + get_dynamic_footprint(token_value);
+    }
+
     const std::string& get_token_value() const {
       return token_value;
     }
@@ -231,37 +116,97 @@ namespace parameter {
     const std::string token_value;
   };
   
+  /*
+   * The members are compiled in the library for int, bool, std::string
+   * and double, see the explicit instantiations in parameter.cpp.
+   */
   template<typename value_type>
   class value: public basic_value {
   public:
     value(const value_type& v): v(v) {}
-      
-    virtual std::string get_type() const {
-      return type_names[get_index_of_element<value_type, value_type_list>::value];
-    }
+
+    virtual std::string get_type() const;
 
     virtual std::string print_value() const;
 
-    virtual basic_value* clone() const {
-      return new value<value_type>(*this);
-    }
+    virtual basic_value* clone() const;
 
     virtual const basic_value* eval(const collection& c) const;
-    
+
+    virtual std::size_t get_memory_footprint() const;
+
     const value_type& get_value() const { return v; }
-      
+
   private:
     const value_type v;
   };
 
-  template<typename value_type>
-  const basic_value* value<value_type>::eval(const collection& c) const {
-      return clone();
-  }
+  template<>
+  std::string value<std::string>::print_value() const;
+
+  template<>
+  std::string value<bool>::print_value() const;
 
   template<>
   const basic_value* value<std::string>::eval(const collection& c) const;
 
+  template<>
+  std::size_t value<std::string>::get_memory_footprint() const;
+
+  extern template class value<int>;
+  extern template class value<bool>;
+  extern template class value<std::string>;
+  extern template class value<double>;
+
+  struct table_column;
+
+  /*
+   * A column of an imported table, which refers to the table storage
+   * instead of holding a copy of the elements. Compiled in the library
+   * for int and double.
+   */
+  template<typename element_type>
+  class column_value: public basic_value {
+  public:
+    column_value(const table_column& c);
+
+    virtual std::string get_type() const;
+
+    virtual std::string print_value() const;
+
+    virtual basic_value* clone() const;
+
+    virtual const basic_value* eval(const collection& c) const;
+
+    virtual std::size_t get_memory_footprint() const;
+
+    const element_type* get_data() const { return data; }
+    std::size_t get_size() const { return size; }
+
+  private:
+    std::shared_ptr<const void> owner;
+    const element_type* data;
+    std::size_t size;
+  };
+
+  extern template class column_value<int>;
+  extern template class column_value<double>;
+
+  template<typename element_type>
+  struct column_view {
+    const element_type* data;
+    std::size_t size;
+
+    const element_type* begin() const { return data; }
+    const element_type* end() const { return data + size; }
+    const element_type& operator[](std::size_t i) const { return data[i]; }
+  };
+
+  /*
+   * Reference to another key, which evaluates to the value of the key
+   * as get_resolved_value gives it: the references followed and the
+   * strings interpolated.
+   */
   class value_ref: public basic_value {
   public:
     value_ref(const std::string& key): key(key) {}
@@ -273,34 +218,201 @@ namespace parameter {
 
     virtual basic_value* clone() const { return new value_ref(*this); }
 
+    const std::string& get_key() const { return key; }
+
     virtual const basic_value* eval(const collection& c) const;
+
+    virtual std::size_t get_memory_footprint() const {
+      return sizeof(*this) + get_dynamic_footprint(key);
+    }
     
   private:
     const std::string key;
   };
 
+  struct lazy_source;
+  struct lazy_definition;
+  struct shared_key;
+  class shared_image;
 
-  template<typename value_type>
-  std::string value<value_type>::print_value() const {
-    std::ostringstream oss; oss << v;
-    return oss.str();
-  }
+  class collection {
+  public:
+    using multi_index = std::vector<std::size_t>;
 
-  template<>
-  std::string value<std::string>::print_value() const;
+    /*
+     * The sweep dimensions of the collection. Only dimensions with more
+     * than one value are registered, single valued keys do not take
+     * part in the sweep. A dimension dies when no key refers to it
+     * anymore (after redefinitions), it then keeps a size of one until
+     * compact() removes it and renumbers the remaining dimensions.
+     */
+    class dimension_table {
+    public:
+      static constexpr std::size_t no_dimension = static_cast<std::size_t>(-1);
+
+      dimension_table(): dead_dimension_number(0), is_cost_ordered(false) {}
+
+      std::size_t add(std::size_t size, std::size_t key_number) {
+        sizes.push_back(size);
+        selection.push_back(0ul);
+        key_numbers.push_back(key_number);
+        costs.push_back(0.);
+        order.clear();
+        return sizes.size() - 1;
+      }
 
-  template<>
-  std::string value<bool>::print_value() const;
+      void release(std::size_t id) {
+        if (id == no_dimension)
+          return;
 
+        key_numbers[id] -= 1;
+        if (key_numbers[id] == 0) {
+          sizes[id] = 1;
+          selection[id] = 0;
+          dead_dimension_number += 1;
+        }
+      }
+
+      void resize(std::size_t id, std::size_t size) {
+        sizes[id] = size;
+        selection[id] = 0;
+      }
+
+      /*
+       * Add a value at the end of a dimension, the selection is kept.
+       */
+      void grow(std::size_t id) { sizes[id] += 1; }
+
+      void set_selection(const multi_index& s) { selection = s; }
+
+      std::size_t get_size(std::size_t id) const { return sizes[id]; }
+      std::size_t get_key_number(std::size_t id) const { return key_numbers[id]; }
+      std::size_t get_dimension_number() const { return sizes.size(); }
+      bool has_dead_dimensions() const { return dead_dimension_number > 0; }
+
+      std::size_t get_point_number() const;
+
+      void select(std::size_t i);
+
+      /*
+       * Step of the collection index between two consecutive values of
+       * each dimension, found with select so that it follows the same
+       * nesting.
+       */
+      multi_index get_strides() const;
+
+      /*
+       * Once a cost is set, the dimensions are nested by increasing
+       * cost: the cheapest one changes at every point, the most
+       * expensive one changes least often. Dimensions of equal cost
+       * keep their definition order.
+       */
+      void reset_costs() {
+        std::fill(costs.begin(), costs.end(), 0.);
+        is_cost_ordered = false;
+        order.clear();
+      }
+
+      void set_cost(std::size_t id, double cost) {
+        costs[id] = std::max(costs[id], cost);
+        is_cost_ordered = true;
+        order.clear();
+      }
+
+      double get_cost(std::size_t id) const { return costs[id]; }
+
+      /*
+       * Dimension ids from the fastest changing to the slowest changing.
+       */
+      const std::vector<std::size_t>& get_order() {
+        if (order.size() != sizes.size())
+          update_order();
+        return order;
+      }
+
+      const multi_index& get_selection() const { return selection; }
+      const multi_index& get_sizes() const { return sizes; }
+
+      /*
+       * Remove the dead dimensions, and return the map from the old
+       * dimension ids to the new ones (no_dimension for removed ones).
+       */
+      std::vector<std::size_t> compact() {
+        std::vector<std::size_t> remap(sizes.size(), no_dimension);
+        std::size_t n(0);
+        for (std::size_t id(0); id < sizes.size(); ++id)
+          if (key_numbers[id] > 0) {
+            remap[id] = n;
+            sizes[n] = sizes[id];
+            selection[n] = selection[id];
+            key_numbers[n] = key_numbers[id];
+            costs[n] = costs[id];
+            n += 1;
+          }
+
+        sizes.resize(n);
+        selection.resize(n);
+        key_numbers.resize(n);
+        costs.resize(n);
+        order.clear();
+        dead_dimension_number = 0;
+
+        return remap;
+      }
+
+      void clear() {
+        sizes.clear();
+        selection.clear();
+        key_numbers.clear();
+        costs.clear();
+        order.clear();
+        dead_dimension_number = 0;
+        is_cost_ordered = false;
+      }
+
+      std::size_t get_memory_footprint() const {
+        return (sizes.capacity() + selection.capacity() + key_numbers.capacity() + order.capacity())
+          * sizeof(std::size_t) + costs.capacity() * sizeof(double);
+      }
+
+    private:
+      multi_index sizes;
+      multi_index selection;
+      std::vector<std::size_t> key_numbers;
+      std::vector<double> costs;
+      std::vector<std::size_t> order;
+      std::size_t dead_dimension_number;
+      bool is_cost_ordered;
+
+    private:
+      void update_order() {
+        order.resize(sizes.size());
+        for (std::size_t id(0); id < order.size(); ++id)
+          order[id] = id;
+        std::stable_sort(order.begin(), order.end(),
+                         [this](std::size_t a, std::size_t b) { return costs[a] < costs[b]; });
+      }
+    };
 
-  class collection {
-  public:
-    using multi_index = std::vector<std::size_t>;
     struct multi_value {
       std::size_t index_id;
-      std::vector<basic_value*> values;
+
+      // lazy values are converted in place by the first access, which
+      // does not change the values seen through the const interface:
+      // until then values is empty, and the values are the
+      // lazy_value_number tokens of the text of lazy_text which start
+      // at lazy_offset
+      mutable std::vector<basic_value*> values;
+      mutable std::atomic<bool> is_lazy;
+      mutable std::shared_ptr<const lazy_source> lazy_text;
+      std::size_t lazy_offset;
+      std::size_t lazy_value_number;
 
       basic_value* get_value(const multi_index& is) const {
+        if (values.empty())
+          throw std::string("no value in multivalue");
+        if (index_id == dimension_table::no_dimension)
+          return values.front();
         if (is[index_id] >= values.size())
           throw string_builder("index out of bound in multivalue: ")
             (is[index_id])(" >= ")(values.size())
@@ -311,15 +423,40 @@ namespace parameter {
         return get_value(is)->get_type();
       }
 
-      std::size_t get_value_number() const { return values.size(); }
+      std::size_t get_value_number() const {
+        return is_lazy.load(std::memory_order_acquire) ? lazy_value_number : values.size();
+      }
       void append_value(basic_value* v) { values.push_back(v); }
 
       std::size_t get_index_id() const { return index_id; }
       void set_index_id(std::size_t id) { index_id = id; }
+
+      /*
+       * Convert the lazy values, once even when several threads access
+       * the key at the same time.
+       */
+      void materialize() const {
+        if (is_lazy.load(std::memory_order_acquire))
+          materialize_values();
+      }
+
+      /*
+       * Values left as the value_number tokens of the source text from
+       * offset, as the lazy scanner located them.
+       */
+      void set_lazy_values(const std::shared_ptr<const lazy_source>& source,
+                           std::size_t offset, std::size_t value_number) {
+        lazy_text = source;
+        lazy_offset = offset;
+        lazy_value_number = value_number;
+        is_lazy.store(true);
+      }
       
-      multi_value(): index_id(0) {}
+      multi_value()
+        : index_id(dimension_table::no_dimension), is_lazy(false), lazy_offset(0), lazy_value_number(0) {}
 
-      multi_value(std::size_t index_id, basic_value* v): index_id(index_id) {
+      multi_value(std::size_t index_id, basic_value* v)
+        : index_id(index_id), is_lazy(false), lazy_offset(0), lazy_value_number(0) {
         values.push_back(v);
       }
       
@@ -328,23 +465,61 @@ namespace parameter {
           delete v;
       }
 
-      multi_value(const multi_value& mv): index_id(mv.index_id) {
-        for (const auto v: mv.values)
-          values.push_back(v->clone());
+      /*
+       * The values are owned by exactly one multi_value, and only
+       * copied by an explicit clone.
+       */
+      multi_value(multi_value&& mv) noexcept
+        : index_id(mv.index_id), values(std::move(mv.values)), is_lazy(mv.is_lazy.load()),
+          lazy_text(std::move(mv.lazy_text)), lazy_offset(mv.lazy_offset),
+          lazy_value_number(mv.lazy_value_number) {
+        mv.values.clear();
+        mv.is_lazy.store(false);
       }
 
-      multi_value& operator=(const multi_value& mv) {
-        for (auto v: values)
-          delete v;
-        values.clear();
-        index_id = mv.index_id;
-        for (const auto v: mv.values)
-          values.push_back(v->clone());
-
+      multi_value& operator=(multi_value&& mv) noexcept {
+        if (this != &mv) {
+          for (auto v: values)
+            delete v;
+          index_id = mv.index_id;
+          values = std::move(mv.values);
+          is_lazy.store(mv.is_lazy.load());
+          lazy_text = std::move(mv.lazy_text);
+          lazy_offset = mv.lazy_offset;
+          lazy_value_number = mv.lazy_value_number;
+          mv.values.clear();
+          mv.is_lazy.store(false);
+        }
         return *this;
       }
 
+      multi_value(const multi_value&) = delete;
+      multi_value& operator=(const multi_value&) = delete;
+
+      multi_value clone() const {
+        multi_value mv;
+        mv.index_id = index_id;
+        if (is_lazy.load(std::memory_order_acquire)) {
+          std::lock_guard<std::mutex> lock(get_conversion_mutex());
+          if (is_lazy.load(std::memory_order_relaxed)) {
+            mv.set_lazy_values(lazy_text, lazy_offset, lazy_value_number);
+            return mv;
+          }
+        }
+        mv.values.reserve(values.size());
+        for (const auto v: values)
+          mv.values.push_back(v->clone());
+        return mv;
+      }
+
+    private:
+      static std::mutex& get_conversion_mutex();
+
+      void materialize_values() const;
+
+    public:
       std::string print_values() const {
+        materialize();
         std::ostringstream oss;
         for (std::size_t i(0); i < values.size() - 1; ++i)
           oss << values[i]->print_value() << ", ";
@@ -355,88 +530,131 @@ namespace parameter {
       std::string print_value(const multi_index& is) const {
         return get_value(is)->print_value();
       }
+
+      std::size_t get_memory_footprint() const {
+        std::size_t footprint(values.capacity() * sizeof(basic_value*));
+        for (const auto v: values)
+          footprint += v->get_memory_footprint();
+        return footprint;
+      }
     };
     
-    collection() {}
+    collection()
+      : diagnostics(nullptr), lazy_loading(false), parallel_imports(false),
+        statement_sink(nullptr), loader(nullptr), variant_base(nullptr) {}
     ~collection() { clear(); }
 
     std::size_t get_collection_size() const {
-      return array_element_number(parameter_space_sizes.size(),
-                                  &parameter_space_sizes[0]);
+      return dimensions.get_point_number();
     }
 
     void set_current_collection(std::size_t i) {
-      to_multi_index(parameter_space_sizes.size(),
-                     &selected_parameter_space[0],
-                     &parameter_space_sizes[0],
-                     i, true);
+      dimensions.select(i);
     }
-    
-    void read_from_file(const std::string& filename) {
-      resource_locator config_file(filename);
-      resource_locator cwd(get_current_working_directory());
-      change_directory(config_file.resource_path()); {
-      
-        std::ifstream f(config_file.resource_name().c_str(), std::ios::in);
-        if (not f)
-          throw std::string("file '" + filename + "' is not accessible");
 
-        regex_lexer<token_type> lex(build_lexer());
-      
-        file_source<token_type> fs(&f, filename);
-        lex.set_source(&fs);
+    /*
+     * The current point as the value id selected in each dimension,
+     * indexed as the dimension_table. A shorter point selects the
+     * first value of the missing dimensions.
+     */
+    const multi_index& get_current_point() const { return dimensions.get_selection(); }
+    void set_current_point(const multi_index& point);
+
+    const dimension_table& get_dimension_table() const { return dimensions; }
+
+    /*
+     * Index of the current point restricted to the dimensions of the
+     * given keys, between 0 and get_projection_size(keys). Two points
+     * with the same projection index share the values of these keys,
+     * so it can be used as a cache key for a setup depending on them
+     * only:
+     *
+     *   const std::size_t mesh_id(c.projection_index({"space-subdivisions"}));
+     */
+    std::size_t projection_index(const std::vector<std::string>& keys) const;
 
-        token_source<token_type> ts(&lex);
-        parse_parameter_list(ts);
-      }
+    std::size_t get_projection_size(const std::vector<std::string>& keys) const;
 
-      change_directory(cwd);
+    /*
+     * Declare the relative cost of changing the value of a key. The
+     * sweep then changes expensive keys least often; keys of a group
+     * share a dimension, which takes the largest cost of its keys.
+     * Costs are kept by key, and follow the key through later
+     * redefinitions.
+     */
+    void set_dimension_cost(const std::string& key, double cost) {
+      dimension_costs[key] = cost;
+      update_dimension_costs();
     }
 
-    void set_key_value(const std::string& key, double value) {
-      set_key_value(key, new ::parameter::value<double>(value));
+    void reset_dimension_costs() {
+      dimension_costs.clear();
+      update_dimension_costs();
     }
-    void set_key_value(const std::string& key, bool value) {
-      set_key_value(key, new ::parameter::value<bool>(value));
-    }
-    void set_key_value(const std::string& key, int value) {
-      set_key_value(key, new ::parameter::value<int>(value));
+
+    /*
+     * Keys of each varying dimension, from the slowest changing to the
+     * fastest changing dimension, as set_current_collection sweeps
+     * them.
+     */
+    std::vector<std::vector<std::string> > get_iteration_order() const;
+    
+    void read_from_file(const std::string& filename);
+
+    /*
+     * Parse parameter definitions from a stream or an in-memory
+     * buffer, with the same grammar and redefinition semantics as
+     * read_from_file. The source name only appears in the error
+     * messages, imports are relative to the working directory.
+     */
+    void read_from_stream(std::istream& stream, const std::string& source_name = "<stream>") {
+      parse_stream(stream, source_name, import_directories.empty() ? "." : import_directories.back());
     }
-    void set_key_value(const std::string& key, const std::string& value) {
-      set_key_value(key, new ::parameter::value<std::string>(value));
+
+    void read_from_string(const std::string& text, const std::string& source_name = "<string>") {
+      std::istringstream stream(text);
+      read_from_stream(stream, source_name);
     }
 
+    /*
+     * Apply the command line arguments of the form
+     *
+     *   --key=value[, value...]
+     *   --override key=value[, value...]
+     *   --override=key=value[, value...]
+     *
+     * as definitions parsed by the regular parser, the first form being
+     * a plain definition and the others an 'override' one. Note that
+     * string values have to keep their double quotes through the shell,
+     * as in --output-prefix='"run-{n}"'. The other arguments, except
+     * argv[0], are returned in order.
+     */
+    std::vector<std::string> apply_overrides(int argc, const char* const* argv);
+
+    void set_key_value(const std::string& key, double value);
+    void set_key_value(const std::string& key, bool value);
+    void set_key_value(const std::string& key, int value);
+    void set_key_value(const std::string& key, const std::string& value);
+    void set_enum_key_value(const std::string& key, const std::string& token_value);
+
+    /*
+     * Append a value to a key which is single valued or alone in its
+     * dimension, as an adaptive sweep does while iterating. The values
+     * already defined keep their position, called their value id, and
+     * the current point is kept, but the points of the collection are
+     * renumbered. The value must have the type of the values of the
+     * key. Returns the value id of the new value.
+     */
+    std::size_t append_key_value(const std::string& key, double value);
+    std::size_t append_key_value(const std::string& key, int value);
+    std::size_t append_key_value(const std::string& key, bool value);
+    std::size_t append_key_value(const std::string& key, const std::string& value);
+
     template<typename enum_type>
     enum_type get_enum_value(const std::string& key,
                                     const std::map<std::string, enum_type>& token_map) const {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::const_iterator;
-
-      map_iterator_type kv(key_value.find(key));
-      if (kv == key_value.end()) {
-        std::string suggestion;
-        if (make_suggestion(key, suggestion)) {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection, did you mean '"
-                              + suggestion
-                              + "'?");
-        } else {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection");
-        }
-      }
-
-      const basic_value* tmp(kv->second.get_value(selected_parameter_space)->eval(*this));
-      const enum_value* v(dynamic_cast<const enum_value*>(tmp));
-      if (not v) {
-        delete tmp;
-        throw std::string("failed to get an enum value from the key '" + kv->first
-                          + "' which has type " + kv->second.get_type(selected_parameter_space));
-      }
-
-      const auto mapped_enum_value(token_map.find(v->get_token_value()));
+      const std::string token(get_enum_token(key));
+      const auto mapped_enum_value(token_map.find(token));
       if (mapped_enum_value == token_map.end()) {
         std::string enum_value_set;
         for (const auto& ev: token_map) {
@@ -444,608 +662,466 @@ namespace parameter {
           enum_value_set += " ";
         }
 
-        delete tmp;
         throw std::string("The value '"
-                          + v->get_token_value()
+                          + token
                           + "' is not among the enum value set. Accepted value for the key '"
                           + key
                           +"' is one of { "
                           + enum_value_set
                           + "}.");
-      } else {
-        auto result(mapped_enum_value->second);
-        delete tmp;
-        return result;
       }
+      return mapped_enum_value->second;
     }
+
+    std::string get_enum_token(const std::string& key) const;
     
+    /*
+     * Compiled in the library for the value types of the collection:
+     * int, bool, std::string and double.
+     */
     template<typename value_type>
     value_type get_value(const std::string& key) const {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::const_iterator;
-
-      map_iterator_type kv(key_value.find(key));
-      if (kv == key_value.end()) {
-        std::string suggestion;
-        if (make_suggestion(key, suggestion)) {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection, did you mean '"
-                              + suggestion
-                              + "'?");
-        } else {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection");
-        }
-      }
+      static_assert(value_type_index<value_type>::value >= 0,
+                    "the value type is not one of int, bool, std::string and double");
+      value_type result;
+      if (not lookup_value(key, result))
+        throw_undefined_key(key);
+      return result;
+    }
 
-      const basic_value* tmp(kv->second.get_value(selected_parameter_space)->eval(*this));
-      const value<value_type>* v(dynamic_cast<const value<value_type>*>(tmp));
-      if (not v)
-        throw std::string("failed to get a "
-                          + std::string(basic_value::type_names[get_index_of_element<value_type, basic_value::value_type_list>::value])
-                          + " from the key '" + kv->first
-                          + "' which has type " + kv->second.get_type(selected_parameter_space));
+    /*
+     * Lookups of optional keys. An undefined key is not an error here:
+     * no suggestion is searched and nothing is thrown, so that probing
+     * an absent key costs a single map lookup. A defined key of another
+     * type still throws as get_value does.
+     */
+    template<typename value_type>
+    bool try_get_value(const std::string& key, value_type& result) const {
+      return lookup_value(key, result);
+    }
 
-      value_type result(v->get_value());
-      delete tmp;
-      return result;
+    template<typename value_type>
+    value_type get_value_or(const std::string& key, const value_type& default_value) const {
+      value_type result;
+      return lookup_value(key, result) ? result : default_value;
     }
 
-    const basic_value* get_basic_value(const std::string& key) const {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::const_iterator;
-
-      map_iterator_type kv(key_value.find(key));
-      if (kv == key_value.end()) {
-        std::string suggestion;
-        if (make_suggestion(key, suggestion)) {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection, did you mean '"
-                              + suggestion
-                              + "'?");
-        } else {
-            throw std::string("the key '"
-                              + key
-                              + "' is not found in the parameter collection");
-        }
-      }
+    std::string get_value_or(const std::string& key, const char* default_value) const {
+      return get_value_or<std::string>(key, default_value);
+    }
+
+    bool contains(const std::string& key) const;
+
+    /*
+     * Zero-copy access to a column imported from a table.
+     */
+    template<typename element_type>
+    column_view<element_type> get_column(const std::string& key) const;
+
+    /*
+     * Values of the key at the points [first, last) of the collection,
+     * or at a list of points, written to out, without changing the
+     * current point. Plain values are copied by runs of points sharing
+     * a value; values referring to other keys are resolved once per
+     * combination of the dimensions they depend on. Compiled for the
+     * value types of the collection.
+     */
+    template<typename value_type>
+    void evaluate_column(const std::string& key, std::size_t first, std::size_t last,
+                         value_type* out) const;
+
+    template<typename value_type>
+    void evaluate_column(const std::string& key, const std::vector<std::size_t>& indices,
+                         value_type* out) const;
+
+    /*
+     * Value of the key at the point i, as get_basic_value(key)->eval
+     * gives it once the point is selected, without changing the current
+     * point. Owned by the caller.
+     */
+    const basic_value* evaluate_at(const std::string& key, std::size_t i) const;
+
+    /*
+     * Dimensions the value of the key depends on: its own and the ones
+     * of the keys it refers to or interpolates, directly or not. Points
+     * selecting the same values in these dimensions give the key the
+     * same value.
+     */
+    std::vector<std::size_t> get_dependency_dimensions(const std::string& key) const;
+
+    const basic_value* get_basic_value(const std::string& key) const;
+
+    /*
+     * Value of the key at the current point with the references
+     * followed and the strings interpolated, owned by the caller.
+     */
+    const basic_value* get_resolved_value(const std::string& key) const;
+
+    std::vector<std::string> get_keys() const;
+
+    /*
+     * Keys starting with the prefix, such as the keys of a namespace
+     * with the prefix "solver.". The keys being sorted, the range is
+     * found by a single lookup, and the cost is proportional to the
+     * number of keys returned.
+     */
+    std::vector<std::string> get_keys_with_prefix(const std::string& prefix) const;
 
-      return kv->second.get_value(selected_parameter_space);
+    /*
+     * Keys matching a pattern where '*' stands for any sequence of
+     * characters and '?' for any character. Only the keys starting with
+     * the literal beginning of the pattern are tested.
+     */
+    std::vector<std::string> get_keys_matching(const std::string& pattern) const;
+
+    const multi_value& get_multi_value(const std::string& key) const;
+
+    /*
+     * In lazy loading mode, the files are only scanned for the location
+     * of the definitions, and the values of a key are tokenized and
+     * converted the first time it, or a key referring to it, is
+     * accessed. Files using syntax the scanner does not handle are
+     * parsed as usual. The conversion is synchronized, so that the same
+     * collection can be read from several threads, and materialize_all
+     * converts every value ahead. Enabling the mode first checks, once
+     * per process, that the scanner splits the tokens as the lexer
+     * does; if not, is_lazy_loading stays false.
+     */
+    void set_lazy_loading(bool enabled);
+    bool is_lazy_loading() const { return lazy_loading; }
+
+    /*
+     * With parallel imports, read_from_file parses the imported files
+     * concurrently into lists of statements, each file being scheduled
+     * as soon as its import statement is parsed. The lists are then
+     * applied in source order, so that the resulting collection,
+     * warnings and errors are the same as with the sequential parse.
+     */
+    void set_parallel_imports(bool enabled) { parallel_imports = enabled; }
+    bool has_parallel_imports() const { return parallel_imports; }
+
+    void materialize_all() {
+      for (auto& kv: key_value)
+        materialize(kv.second);
     }
 
-    void clear() {
-      key_value.clear();
-      parameter_space_sizes.clear();
-      selected_parameter_space.clear();
+    /*
+     * When a diagnostic sink is set, parse errors and warnings are
+     * appended to it and the parser resumes at the next statement
+     * instead of throwing. An error of the lexer ends the parse of its
+     * file. Passing nullptr restores the default behavior.
+     */
+    void set_diagnostic_sink(std::vector<diagnostic>* sink) {
+      diagnostics = sink;
     }
 
-    void print_key_values(std::ostream& stream) const {
-      for (const auto& kv: key_value)
-        stream << kv.second.get_type(selected_parameter_space) << " " << kv.first
-          << " = "
-          << kv.second.print_value(selected_parameter_space) << std::endl;
+    /*
+     * Report every reference and string interpolation, in any value of
+     * the collection, which names an undefined key.
+     */
+    void check_references(std::vector<diagnostic>& d) const;
+
+    std::string get_definition_location(const std::string& key) const;
+
+    instrumentation& get_instrumentation() const { return stats; }
+
+    void enable_instrumentation() { stats.enable(); }
+    void disable_instrumentation() { stats.disable(); }
+
+    void print_access_statistics(std::ostream& stream) const {
+      stats.print(stream);
     }
+
+    /*
+     * Keys which were defined but never read since the instrumentation
+     * was enabled. Throws if the instrumentation is not enabled, or not
+     * compiled in, since the reads are then not recorded.
+     */
+    std::vector<std::string> get_unread_keys() const;
+
+    void print_unread_keys(std::ostream& stream) const;
+
+    memory_usage get_memory_usage() const;
+
+    void clear();
+
+    /*
+     * Share a collection between the processes of a node: the first
+     * process calling read_shared parses the file and publishes the
+     * collection in a POSIX shared memory segment, the other ones wait
+     * for it and attach to it read-only instead of parsing:
+     *
+     *   c.read_shared("sweep.conf", "/sweep-conf");
+     *   ...
+     *   if (rank == 0)
+     *     collection::unlink_shared("/sweep-conf");
+     *
+     * An attached collection reads the values and lists the keys out
+     * of the segment, only get_multi_value and get_basic_value, which
+     * return references into the collection, decode the key they
+     * access, once and under a lock, so that threads can read it.
+     * The sweep and the redefinitions work as usual, redefined keys
+     * being local to the process. The segment is only removed by
+     * unlink_shared, the processes which already attached to it keep
+     * their mapping. A segment published by read_shared from another
+     * file, or from a file modified since, is rejected.
+     */
+    void read_shared(const std::string& filename, const std::string& segment_name);
+
+    void publish_shared(const std::string& segment_name) const;
+
+    void attach_shared(const std::string& segment_name);
+
+    bool is_shared() const { return shared != nullptr; }
+
+    static void unlink_shared(const std::string& segment_name);
+
+    void print_key_values(std::ostream& stream) const;
     
   private:
-    std::map<std::string, multi_value> key_value;
-    multi_index parameter_space_sizes;
-    multi_index selected_parameter_space;
+    /*
+     * The keys and their values, cloned only when the collection is
+     * copied.
+     */
+    struct key_value_map: std::map<std::string, multi_value> {
+      key_value_map() {}
+      key_value_map(key_value_map&&) = default;
+      key_value_map& operator=(key_value_map&&) = default;
+
+      key_value_map(const key_value_map& m): std::map<std::string, multi_value>() {
+        for (const auto& kv: m)
+          emplace_hint(end(), kv.first, kv.second.clone());
+      }
+
+      key_value_map& operator=(const key_value_map& m) {
+        key_value_map copy(m);
+        swap(copy);
+        return *this;
+      }
+    };
+
+    /*
+     * Keys of the shared segment decoded by the const accessors which
+     * return references into the collection. The const accessors never
+     * modify key_value: the decoded keys are kept apart, under a lock
+     * of their own, so that several threads can read the collection.
+     */
+    struct decoded_key_cache {
+      mutable std::mutex m;
+      key_value_map keys;
+
+      decoded_key_cache() {}
+
+      decoded_key_cache(const decoded_key_cache& c) {
+        std::lock_guard<std::mutex> lock(c.m);
+        keys = c.keys;
+      }
+
+      decoded_key_cache& operator=(const decoded_key_cache& c) {
+        decoded_key_cache copy(c);
+        std::lock_guard<std::mutex> lock(m);
+        keys.swap(copy.keys);
+        return *this;
+      }
+    };
+
+    key_value_map key_value;
+    dimension_table dimensions;
+    mutable decoded_key_cache decoded_keys;
+
+    mutable instrumentation stats;
+
+    std::vector<std::string> import_directories;
+    std::vector<diagnostic>* diagnostics;
+    std::map<std::string, std::string> definition_coordinates;
+    std::map<std::string, double> dimension_costs;
+    bool lazy_loading;
+    bool parallel_imports;
+
+    // "a.b." while parsing the statements of the namespace b in a
+    std::string key_prefix;
+
+    // segment the collection is attached to, and the current ids of its
+    // dimensions
+    std::shared_ptr<const shared_image> shared;
+    std::vector<std::size_t> shared_dimension_ids;
+    static constexpr std::uint64_t shared_no_dimension = static_cast<std::uint64_t>(-1);
 
     struct key_value_definition {
       bool is_overriding;
       std::string key;
       multi_value mv;
       std::string coordinates;
+
+      key_value_definition clone() const {
+        return { is_overriding, key, mv.clone(), coordinates };
+      }
     };
 
+    // defined in parameter.cpp
+    template<typename value_type>
+    class column_evaluator;
+
+    // defined in parser.hpp, private to the library
+    struct parsed_statement;
+    struct parsed_file;
+    class import_loader;
+    class parser;
+
+    std::vector<parsed_statement>* statement_sink;
+    import_loader* loader;
+
+    // while a variant is applied to a collection of its own, the
+    // collection importing it, whose keys count as defined for the
+    // override rules
+    const collection* variant_base;
+
   private:
-    std::size_t levenshtein_distance(const std::string& s1, const std::string& s2) const {
-      std::vector<int>
-        v0(s2.size() + 1),
-        v1(s2.size() + 1);
-      
-      std::iota(v0.begin(), v0.end(), 0);
+    void parse_stream(std::istream& stream,
+                      const std::string& source_name,
+                      const std::string& import_directory);
 
-      for (std::size_t i(0); i < s1.size(); ++i) {
-        v0[0] = i + 1;
+    void parse_tokens(std::istream& stream, const std::string& source_name);
 
-        int substitution_cost(0);
-        for (std::size_t j(0); j < s2.size(); ++j) {
-          if (s1[i] == s2[j])
-            substitution_cost = 0;
-          else
-            substitution_cost = 1;
+    void scan_stream(std::istream& stream, const std::string& source_name);
 
-          v1[j + 1] = std::min({v1[j] + 1,
-                                v0[j + 1] + 1,
-                                v0[j] + substitution_cost});
-        }
-        std::swap(v0, v1);
-      }
-      return v0.back();
-    }
-    
-    bool make_suggestion(const std::string& key, std::string& suggestion) const {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::const_iterator;
-
-      map_iterator_type closest_key(
-        std::min_element(key_value.cbegin(),
-                         key_value.cend(),
-                         [&](const map_type::value_type& kv1,
-                             const map_type::value_type& kv2) {
-                           return levenshtein_distance(kv1.first, key) < levenshtein_distance(kv2.first, key);
-                         }));
-      
-      if (closest_key != key_value.end()) {
-        suggestion = closest_key->first;
-        return true;
-      } else {
-        return false;
-      }
+    key_value_definition make_lazy_definition(const std::shared_ptr<const lazy_source>& source,
+                                              const lazy_definition& d) const;
+
+    void materialize(const multi_value& mv) const {
+      // the first access to a key converts its values in place
+      mv.materialize();
     }
 
-    void set_key_value_group(const std::vector<key_value_definition>& defs) {
-      if (defs.size()) {
-        const std::size_t index_id(parameter_space_sizes.size());
-        for (const auto& def: defs) {
-          using map_type = std::map<std::string, multi_value>;
-          using map_iterator_type = map_type::iterator;
-
-          map_iterator_type kv(key_value.find(def.key));
-          if (kv == key_value.end()) {
-            (key_value[def.key] = def.mv).set_index_id(index_id);
-          
-            if (def.is_overriding)
-              throw string_builder("attempt to redefine key '")(def.key)("' which is not (yet) defined.").str();
-
-          } else {
-            const std::size_t old_index_id(kv->second.get_index_id());
-            kv->second = def.mv;
-            kv->second.set_index_id(index_id);
-
-            parameter_space_sizes[old_index_id] = 1;
-              selected_parameter_space[old_index_id] = 0;
-
-            if (not def.is_overriding)
-              std::cerr << "warning: redefinition of key '" << def.key
-                        << "' at " << def.coordinates << ". If it is the intended action, "
-                        << "prefix the definition by the 'override' keyword." << std::endl;;
-          }
-        }
+    std::string resolve_import_path(const std::string& filename) const;
 
-        std::size_t set_size(defs.front().mv.get_value_number());
-        for (const auto& def: defs)
-          if (def.mv.get_value_number() != set_size)
-            throw string_builder("group definition has incoherent element number in definition near ")(def.coordinates)(".").str();
-        
-        parameter_space_sizes.push_back(set_size);
-        selected_parameter_space.push_back(0ul);
-      }
-    }
-    
-    /* 
-     * return false of initial definition, true on redefinition 
-     */
-    bool set_key_value(const std::string& key, basic_value* v) {
-      return set_key_value(key, multi_value(0, v));
-    }
+    void report_error(const std::string& message);
 
-    bool set_key_value(const std::string& key, const multi_value& mv) {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::iterator;
+    void report_warning(const std::string& message);
 
-      map_iterator_type kv(key_value.find(key));
-      if (kv == key_value.end()) {
-        const std::size_t index_id(parameter_space_sizes.size());
-        (key_value[key] = mv).set_index_id(index_id);
-        
-        parameter_space_sizes.push_back(mv.get_value_number());
-        selected_parameter_space.push_back(0ul);
+    /*
+     * The parsers hand their statements to the emit functions, which
+     * either apply them or record them when parsing ahead.
+     */
+    void emit_definition(key_value_definition&& def);
 
-        return false;
-      } else {
-        const std::size_t index_id(kv->second.get_index_id());
-        kv->second = mv;
-        kv->second.set_index_id(index_id);
+    void emit_group(std::vector<key_value_definition>&& defs);
 
-        parameter_space_sizes[index_id] = mv.get_value_number();
-        selected_parameter_space[index_id] = 0;
+    void emit_import(const std::string& filename);
 
-        return true;
-      }
-    }
-    
-    void append_value(const std::string& key, basic_value* v) {
-      using map_type = std::map<std::string, multi_value>;
-      using map_iterator_type = map_type::iterator;
-
-      map_iterator_type kv(key_value.find(key));
-      if (kv == key_value.end()) {
-        throw std::string("trying to append a value to an undefined key '") + key + "'";
-      } else {
-        const std::size_t index_id(kv->second.get_index_id());
-        kv->second.append_value(v);
-
-        parameter_space_sizes[index_id] += 1;
-        selected_parameter_space[index_id] = 0;
-      }
-    }
+    void emit_variants(const std::vector<std::string>& filenames, const std::string& coordinates);
 
-    std::string enum_item_token_to_enum_item(token_type* t) {
-      // remove the leading '#'
-      std::string str(t->value.substr(1, t->value.size() - 1));
-      return str;
-    }
-    
-    std::string string_token_to_string(token_type* t) {
-      // remove the quoting characters and escaped sequences
-      std::string str(t->value.substr(1, t->value.size() - 2));
-
-      std::string::iterator i(str.begin());
-      while (i != str.end()) {
-        if (*i == '\\') {
-          i = str.erase(i);
-          if (i != str.end())
-            ++i;
-        } else {
-          ++i;
-        }
-      }
-      
-      return str;
-    }
-    
-    // FIRST(parameter list) = {key}
-    void parse_parameter_list(token_source<token_type>& ts) {
-      token_type* t(ts.peek());
-
-      while (t->symbol != symbol::eoi) {
-        switch (t->symbol) {
-        case symbol::key:
-        case symbol::override_keyword:
-          parse_global_definition(ts);
-          break;
-        case symbol::lbracket:
-          parse_group_definition(ts);
-          break;
-        case symbol::import:
-          parse_import_statment(ts);
-          break;
-        default:
-          throw string_builder("unexpected ")
-            (t->symbol)
-            (" token at ")
-            (t->render_coordinates())
-            (" instead of a ")
-            (symbol::key)
-            (" token").str();
-        }
-        t = ts.peek();
-      }
-    }
-    
-    void parse_group_definition(token_source<token_type>& ts) {
-      token_type* lbracket_token(ts.get());
-      if (lbracket_token->symbol != symbol::lbracket)
-        throw string_builder("unexpected ")
-          (lbracket_token->symbol)
-          (" token at ")
-          (lbracket_token->render_coordinates())
-          (" instead of a ")
-          (symbol::lbracket)
-          (" token").str();
-
-      std::vector<key_value_definition> defs;
-
-      bool done(false);
-      while (not done) {
-        token_type* current_token(ts.peek());
-
-        switch (current_token->symbol) {
-        case symbol::override_keyword:
-        case symbol::key:
-          defs.push_back(parse_key_value_definition(ts));
-          break;
-
-        case symbol::rbracket:
-          delete ts.get();
-          done = true;
-          break;
-
-        default:
-          throw string_builder("unexpected ")
-            (current_token->symbol)
-            (" token at ")
-            (current_token->render_coordinates()).str();
-        }
-      }
+    void emit_diagnostic(bool is_error, const std::string& message);
 
-      set_key_value_group(defs);
-      
-      delete lbracket_token;
-    }
+    void read_with_parallel_imports(const std::string& filename, const std::string& path);
+
+    void apply_parsed_file(import_loader& l, const std::string& path,
+                           std::vector<std::string>& import_stack);
 
-    void parse_global_definition(token_source<token_type>& ts) {
-      key_value_definition def(parse_key_value_definition(ts));
+    void apply_variants(import_loader& l, const parsed_statement& s,
+                        std::vector<std::string>& import_stack);
 
-      const bool redefinition(set_key_value(def.key, def.mv));
+    void record_definition(const key_value_definition& def);
 
-      if (def.is_overriding and not redefinition)
-        throw string_builder("attempt to redefine key '")(def.key)("' which is not (yet) defined at ")(def.coordinates)(".").str();
+    void set_global_definition(key_value_definition&& def);
 
-      if (redefinition and not def.is_overriding)
-        std::cerr << "warning: redefinition of key '" << def.key
-                  << "' at " << def.coordinates << ". If it is the intended action, "
-                  << "prefix the definition by the 'override' keyword." << std::endl;
+    bool is_defined_by_variant_base(const std::string& key) const {
+      return variant_base and variant_base->contains(key);
     }
 
+    std::size_t levenshtein_distance(const std::string& s1, const std::string& s2) const;
     
+    bool make_suggestion(const std::string& key, std::string& suggestion) const;
 
+    void set_key_value_group(std::vector<key_value_definition>&& defs);
     
-    // FIRST(key_value) = {key, override_keyword}
-    key_value_definition parse_key_value_definition(token_source<token_type>& ts) {
-      key_value_definition def;
-      def.is_overriding = false;
-      
-      token_type *override_keyword_token(ts.peek());
-      if (override_keyword_token->symbol == symbol::override_keyword) {
-        def.is_overriding = true;
-        delete ts.get();
-      }
+    /* 
+     * return false of initial definition, true on redefinition 
+     */
+    bool set_key_value(const std::string& key, basic_value* v);
 
-      
-      token_type
-        *key_token(ts.get()),
-        *equal_token(ts.get());
-
-      if (equal_token->symbol != symbol::equal)
-        throw string_builder("unexpected ")
-          (key_token->symbol)
-          (" token at ")
-          (key_token->render_coordinates())
-          (" instead of a ")
-          (symbol::key).str();
-
-      if (equal_token->symbol != symbol::equal)
-        throw string_builder("unexpected ")
-          (equal_token->symbol)
-          (" token at ")
-          (equal_token->render_coordinates())
-          (" instead of a ")
-          (symbol::equal).str();
-
-      def.coordinates = equal_token->render_coordinates();
-      def.key = key_token->value;
-
-      token_type* value_token(ts.peek());
-      switch (value_token->symbol) {
-      case symbol::integer:
-      case symbol::real:
-      case symbol::boolean:
-      case symbol::string:
-      case symbol::enum_item:
-      case symbol::key:
-        def.mv = parse_value_list(ts);
-        break;
-        
-      default:
-        throw string_builder("unexpected ")
-          (value_token->symbol)
-          (" token at ")
-          (value_token->render_coordinates()).str();
-      }
+    bool set_key_value(const std::string& key, multi_value&& mv);
 
-      delete key_token;
-      delete equal_token;
+    void compact_dimensions();
 
-      return def;
-    }
+    void update_dimension_costs();
 
-    multi_value parse_value_list(token_source<token_type>& ts) {
-      multi_value v;
-      
-      bool done(false);
-      while (not done) {
-        token_type* current_token(ts.peek());
-
-        switch (current_token->symbol) {
-        case symbol::integer:
-          v.append_value(parse_integer_value(ts));
-          break;
-          
-        case symbol::real:
-          v.append_value(parse_real_value(ts));
-          break;
-          
-        case symbol::boolean:
-          v.append_value(parse_boolean_value(ts));
-          break;
-          
-        case symbol::string:
-          v.append_value(parse_string_value(ts));
-          break;
-          
-        case symbol::enum_item:
-          v.append_value(parse_enum_item(ts));
-          break;
-
-        case symbol::key:
-          v.append_value(parse_key_value(ts));
-          break;
-          
-        default:
-          throw string_builder("unexpected ")
-          (current_token->symbol)
-          (" token at ")
-          (current_token->render_coordinates()).str();
-        }
-        
-        token_type* comma_token(ts.peek());
-        if (comma_token->symbol == symbol::comma)
-          delete ts.get();
-        else
-          done = true;
-      }
-
-      return v;
-    }
-
-    // FIRST(integer_value) = {integer}
-    basic_value* parse_integer_value(token_source<token_type>& ts) {
-      token_type* integer_token(ts.get());
-      if (integer_token->symbol != symbol::integer)
-        throw string_builder("unexpected ")
-          (integer_token->symbol)
-          (" token at ")
-          (integer_token->render_coordinates())
-          (" instead of a ")(symbol::integer).str();
-
-      std::size_t pos(0);
-      basic_value* v(new ::parameter::value<int>(std::stoi(integer_token->value, &pos)));
-      if (pos != integer_token->value.size())
-        throw string_builder("failed to convert ")
-          (integer_token->symbol)
-          (" token at ")
-          (integer_token->render_coordinates())
-          (" to an integer value ").str();
-      
-      delete integer_token;
+    std::vector<std::size_t> get_projection_dimensions(const std::vector<std::string>& keys) const;
 
-      return v;
-    }
+    void add_dependency_dimensions(const std::string& key, std::set<std::string>& visited,
+                                   std::vector<std::size_t>& ids) const;
 
-    // FIRST(integer_value) = {real}
-    basic_value* parse_real_value(token_source<token_type>& ts) {
-      token_type* real_token(ts.get());
-      if (real_token->symbol != symbol::real)
-        throw string_builder("unexpected ")
-          (real_token->symbol)
-          (" token at ")
-          (real_token->render_coordinates())
-          (" instead of a ")
-          (symbol::real).str();
-
-      std::size_t pos(0);
-      basic_value* v(new ::parameter::value<double>(std::stod(real_token->value, &pos)));
-      if (pos != real_token->value.size())
-        throw string_builder("failed to convert ")
-          (real_token->symbol)
-          (" token at ")
-          (real_token->render_coordinates())
-          (" to an real value ").str();
-      
-      delete real_token;
+    /*
+     * Selection the values are read at: the current point, or the point
+     * a column_evaluator of the calling thread is resolving.
+     */
+    const multi_index& get_read_selection() const;
+    
+    /*
+     * Evaluate the value of the key at the current point, stored in the
+     * collection or decoded from the shared segment.
+     */
+    template<typename value_type>
+    value_type read_value(const std::string& key, const basic_value* stored) const;
 
-      return v;
-    }
+    /*
+     * Read the key if it is defined, without copying it out of the
+     * shared segment.
+     */
+    template<typename value_type>
+    bool lookup_value(const std::string& key, value_type& result) const;
 
-    // FIRST(integer_value) = {string}
-    basic_value* parse_string_value(token_source<token_type>& ts) {
-      token_type* string_token(ts.get());
-      if (string_token->symbol != symbol::string)
-        throw string_builder("unexpected ")
-          (string_token->symbol)
-          (" token at ")
-          (string_token->render_coordinates())
-          (" instead of a ")(symbol::real).str();
-
-      basic_value* v(new ::parameter::value<std::string>(string_token_to_string(string_token)));
-      
-      delete string_token;
+    /*
+     * Value of the key at the current point, either stored in the
+     * collection or decoded from the shared segment into decoded,
+     * nullptr when the key is not defined.
+     */
+    const basic_value* find_current_value(const std::string& key,
+                                          std::unique_ptr<const basic_value>& decoded) const;
 
-      return v;
-    }
+    /*
+     * Throw the error of an undefined key, with a suggestion.
+     */
+    [[noreturn]] void throw_undefined_key(const std::string& key) const;
 
-    // FIRST(enum_token) = {enum_token}
-    basic_value* parse_enum_item(token_source<token_type>& ts) {
-      token_type* enum_item_token(ts.get());
-      if (enum_item_token->symbol != symbol::enum_item)
-        throw string_builder("unexpected ")
-          (enum_item_token->symbol)
-          (" token at ")
-          (enum_item_token->render_coordinates())
-          (" instead of a ")(symbol::real).str();
-
-      basic_value* v(new ::parameter::enum_value(enum_item_token_to_enum_item(enum_item_token)));
-      
-      delete enum_item_token;
+    const multi_value& find_defined_key(const std::string& key) const;
 
-      return v;
-    }
+    /*
+     * Look a key up in the collection, or in the shared segment the
+     * collection is attached to, decoding it once into decoded_keys.
+     * nullptr when the key is not defined.
+     */
+    const multi_value* find_key(const std::string& key) const;
 
-    // FIRST(integer_value) = {boolean}
-    basic_value* parse_boolean_value(token_source<token_type>& ts) {
-      token_type* boolean_token(ts.get());
-      if (boolean_token->symbol != symbol::boolean)
-        throw string_builder("unexpected ")
-          (boolean_token->symbol)
-          (" token at ")
-          (boolean_token->render_coordinates())
-          (" instead of a ")(symbol::real).str();
-
-      basic_value* v(nullptr);
-      if (boolean_token->value == "on" or
-          boolean_token->value == "yes" or
-          boolean_token->value == "true")
-        v = new ::parameter::value<bool>(true);
-      else if (boolean_token->value == "off" or
-               boolean_token->value == "no" or
-               boolean_token->value == "false")
-        v = new ::parameter::value<bool>(false);
-      else
-        throw string_builder("failed to convert ")
-          (boolean_token->symbol)
-          (" token at ")
-          (boolean_token->render_coordinates())
-          (" to an real value ").str();
-      
-      delete boolean_token;
+    /*
+     * Copy a key of the shared segment into the collection, before it
+     * is modified, unless the collection already holds it.
+     */
+    void copy_shared_key(const std::string& key);
 
-      return v;
-    }
+    basic_value* decode_shared_value(std::size_t i) const;
 
-    basic_value* parse_key_value(token_source<token_type>& ts) {
-      token_type* key_token(ts.get());
-      if (key_token->symbol != symbol::key)
-        throw string_builder("unexpected ")
-          (key_token->symbol)(" token at ")
-          (key_token->render_coordinates())(" instead of a ")(symbol::key).str();
+    multi_value decode_shared_key(const shared_key& k) const;
 
-      basic_value* v(new ::parameter::value_ref(key_token->value));
+    /*
+     * Call f with the name and the values of every key, the keys of the
+     * shared segment not copied in the collection being decoded one at
+     * a time. Defined in parameter.cpp.
+     */
+    template<typename function_type>
+    void for_each_key_value(function_type f) const;
 
-      delete key_token;
+    static bool match_glob(const std::string& pattern, const std::string& str);
 
-      return v;
-    }
+    /*
+     * Layout the collection as described in shared.hpp. Table columns
+     * refer to mapped files of the process and cannot be published.
+     */
+    std::string build_shared_image(const std::string& source_filename) const;
 
-    void parse_import_statment(token_source<token_type>& ts) {
-      token_type
-        *import_token(ts.get()),
-        *string_token(ts.get());
-
-      if (import_token->symbol != symbol::import)
-        throw string_builder("unexpected ")
-          (import_token->symbol)
-          (" token at ")
-          (import_token->render_coordinates())
-          (" instead of a ")(symbol::import).str();
-
-      if (string_token->symbol != symbol::string)
-        throw string_builder("unexpected ")
-          (string_token->symbol)
-          (" token at ")
-          (string_token->render_coordinates())
-          (" instead of a ")(symbol::string).str();
-
-      read_from_file(string_token_to_string(string_token));
-    }
+    std::size_t append_value(const std::string& key, basic_value* v);
   };
 
-  
 }
 
 #endif /* PARAMETER_H */
@@ -0,0 +1,1307 @@
+#include "parser.hpp"
+
+namespace parameter {
+
+  std::ostream& operator<<(std::ostream& stream, symbol s) {
+    switch (s) {
+    case symbol::eoi:
+      stream << "<eoi>"; break;
+    case symbol::key:
+      stream << "<key>"; break;
+    case symbol::import:
+      stream << "<import>"; break;
+    case symbol::equal:
+      stream << "<equal>"; break;
+    case symbol::value:
+      stream << "<value>"; break;
+    case symbol::string:
+      stream << "<string>"; break;
+    case symbol::real:
+      stream << "<real>"; break;
+    case symbol::integer:
+      stream << "<integer>"; break;
+    case symbol::boolean:
+      stream << "<boolean>"; break;
+    case symbol::enum_item:
+      stream << "<enum_token>"; break;
+    case symbol::override_keyword:
+      stream << "<override>"; break;
+    case symbol::comma:
+      stream << "<comma>"; break;
+    case symbol::lbracket:
+      stream << "<lbracket>"; break;
+    case symbol::rbracket:
+      stream << "<rbracket>"; break;
+    case symbol::lbrace:
+      stream << "<lbrace>"; break;
+    case symbol::rbrace:
+      stream << "<rbrace>"; break;
+    case symbol::lparen:
+      stream << "<lparen>"; break;
+    case symbol::rparen:
+      stream << "<rparen>"; break;
+    }
+    return stream;
+  }
+
+  
+  symbol to_symbol(lazy_token::kind k) {
+    switch (k) {
+    case lazy_token::kind::key: return symbol::key;
+    case lazy_token::kind::boolean: return symbol::boolean;
+    case lazy_token::kind::string: return symbol::string;
+    case lazy_token::kind::real: return symbol::real;
+    case lazy_token::kind::integer: return symbol::integer;
+    case lazy_token::kind::equal: return symbol::equal;
+    case lazy_token::kind::enum_item: return symbol::enum_item;
+    case lazy_token::kind::import: return symbol::import;
+    case lazy_token::kind::override_keyword: return symbol::override_keyword;
+    case lazy_token::kind::comma: return symbol::comma;
+    case lazy_token::kind::lbracket: return symbol::lbracket;
+    case lazy_token::kind::rbracket: return symbol::rbracket;
+    case lazy_token::kind::lbrace: return symbol::lbrace;
+    case lazy_token::kind::rbrace: return symbol::rbrace;
+    case lazy_token::kind::lparen: return symbol::lparen;
+    case lazy_token::kind::rparen: return symbol::rparen;
+    case lazy_token::kind::eoi: break;
+    }
+    return symbol::eoi;
+  }
+
+  regex_lexer<token_type> build_lexer() {
+    regex_lexer_builder<token_type> rlb(symbol::eoi); {
+      for (const auto& rule: token_rules)
+        rlb.emit(to_symbol(rule.k), rule.pattern);
+      
+      rlb.skip(blank_pattern);
+    }
+
+    return rlb.build();
+  }
+
+  bool lazy_scanner_matches_lexer() {
+    static const bool matches([]() {
+        // every rule, the ties between them, tabs and comments
+        const std::string probe("key.sub-a_b = true, false, yes, no, on, off\n"
+                                "\t; comment\n"
+                                " x: \"s\\\"\\\\\" -> 1.5, .5, 5., 1e3, 2E-2, -3, +4, 7, 3e, 1.e5\n"
+                                "\toverride import #item [ ] ( ) { } , truex on1 -.5 import-file\n");
+        const lazy_source source = { "<probe>", probe };
+
+        std::vector<lazy_token> tokens;
+        if (not lazy_scanner(probe).tokenize(tokens))
+          return false;
+
+        try {
+          std::istringstream stream(probe);
+          regex_lexer<token_type> lex(build_lexer());
+          file_source<token_type> fs(&stream, source.name);
+          lex.set_source(&fs);
+
+          for (const auto& t: tokens) {
+            const std::unique_ptr<token_type> lexed(lex.get());
+            if (lexed->symbol != to_symbol(t.k)
+                or lexed->render_coordinates() != source.render_coordinates(t.offset)
+                or (t.k != lazy_token::kind::eoi and lexed->value != probe.substr(t.offset, t.length)))
+              return false;
+          }
+        }
+        catch (...) {
+          return false;
+        }
+        return true;
+      }());
+    return matches;
+  }
+
+  basic_value* convert_lazy_token(const lazy_source& source, const lazy_token& t) {
+    const std::string token(source.text.substr(t.offset, t.length));
+    std::size_t pos(0);
+
+    switch (t.k) {
+    case lazy_token::kind::integer: {
+      int i(0);
+      try {
+        i = std::stoi(token, &pos);
+      }
+      catch (const std::logic_error&) {
+        pos = 0;
+      }
+      if (pos != token.size())
+        throw string_builder("failed to convert ")(symbol::integer)(" token at ")
+          (source.render_coordinates(t.offset))(" to an integer value ").str();
+      return new ::parameter::value<int>(i);
+    }
+
+    case lazy_token::kind::real: {
+      double d(0.);
+      try {
+        d = std::stod(token, &pos);
+      }
+      catch (const std::logic_error&) {
+        pos = 0;
+      }
+      if (pos != token.size())
+        throw string_builder("failed to convert ")(symbol::real)(" token at ")
+          (source.render_coordinates(t.offset))(" to an real value ").str();
+      return new ::parameter::value<double>(d);
+    }
+
+    case lazy_token::kind::boolean:
+      return new ::parameter::value<bool>(token == "on" or token == "yes" or token == "true");
+
+    case lazy_token::kind::string:
+      return new ::parameter::value<std::string>(lazy_scanner(source.text).unescape(t));
+
+    case lazy_token::kind::enum_item:
+      return new ::parameter::enum_value(token.substr(1));
+
+    case lazy_token::kind::key:
+      return new ::parameter::value_ref(token);
+
+    default:
+      throw string_builder("unexpected token at ")(source.render_coordinates(t.offset)).str();
+    }
+  }
+
+  void collection::set_lazy_loading(bool enabled) {
+    lazy_loading = enabled and lazy_scanner_matches_lexer();
+  }
+
+  void collection::read_from_file(const std::string& filename) {
+#ifdef PARAMETER_INSTRUMENTATION
+    const instrumentation::clock::time_point start(instrumentation::clock::now());
+#endif
+    // imports are relative to the importing file, the working
+    // directory is left untouched so that several collections can be
+    // read concurrently
+    const std::string path(resolve_import_path(filename));
+    if (parallel_imports and import_directories.empty() and not statement_sink) {
+      read_with_parallel_imports(filename, path);
+    } else {
+      std::ifstream f(path.c_str(), std::ios::in);
+      if (not f)
+        throw std::string("file '" + filename + "' is not accessible");
+
+      parse_stream(f, path, resource_locator(path).resource_path().to_string());
+    }
+
+    PARAMETER_INSTRUMENT(stats, stats.record_parse(filename, instrumentation::clock::now() - start));
+  }
+
+  void collection::parse_stream(std::istream& stream,
+                                const std::string& source_name,
+                                const std::string& import_directory) {
+    import_directories.push_back(import_directory);
+    try {
+      if (lazy_loading)
+        scan_stream(stream, source_name);
+      else
+        parse_tokens(stream, source_name);
+    }
+    catch (...) {
+      import_directories.pop_back();
+      throw;
+    }
+    import_directories.pop_back();
+
+    if (import_directories.empty())
+      compact_dimensions();
+  }
+
+  void collection::parse_tokens(std::istream& stream, const std::string& source_name) {
+    regex_lexer<token_type> lex(build_lexer());
+
+    file_source<token_type> fs(&stream, source_name);
+    lex.set_source(&fs);
+
+    try {
+      token_source<token_type> ts(&lex);
+      parser(*this).parse_parameter_list(ts);
+    }
+    catch (const lexical_error& e) {
+      // the statements before the error are kept
+      report_error(e.message + ", the rest of '" + source_name + "' is not read");
+    }
+  }
+
+  void collection::scan_stream(std::istream& stream, const std::string& source_name) {
+    std::ostringstream buffer;
+    buffer << stream.rdbuf();
+
+    std::shared_ptr<lazy_source> source(std::make_shared<lazy_source>());
+    source->name = source_name;
+    source->text = buffer.str();
+
+    std::vector<lazy_statement> statements;
+    std::vector<lazy_definition> definitions;
+    if (not lazy_scanner(source->text).scan(statements, definitions)) {
+      std::istringstream text(source->text);
+      parse_tokens(text, source_name);
+      return;
+    }
+
+    for (const auto& s: statements) {
+      try {
+        switch (s.k) {
+        case lazy_statement::kind::import:
+          emit_import(lazy_scanner(source->text).unescape(s.import_filename));
+          break;
+
+        case lazy_statement::kind::definition:
+          emit_definition(make_lazy_definition(source, definitions[s.first_definition]));
+          break;
+
+        case lazy_statement::kind::group: {
+          std::vector<key_value_definition> defs;
+          for (std::size_t i(0); i < s.definition_number; ++i)
+            defs.push_back(make_lazy_definition(source, definitions[s.first_definition + i]));
+          emit_group(std::move(defs));
+          break;
+        }
+        }
+      }
+      catch (const std::string& e) {
+        if (not diagnostics)
+          throw;
+        report_error(e);
+      }
+    }
+  }
+
+  collection::key_value_definition
+  collection::make_lazy_definition(const std::shared_ptr<const lazy_source>& source,
+                                   const lazy_definition& d) const {
+    key_value_definition def;
+    def.is_overriding = d.is_overriding;
+    def.key = source->text.substr(d.key_offset, d.key_length);
+    def.coordinates = source->render_coordinates(d.line, d.column);
+    def.mv.set_lazy_values(source, d.value_offset, d.value_number);
+    return def;
+  }
+
+  std::string collection::resolve_import_path(const std::string& filename) const {
+    if (import_directories.empty() or filename.empty() or filename[0] == '/')
+      return filename;
+    else
+      return import_directories.back() + "/" + filename;
+  }
+
+  void collection::report_error(const std::string& message) {
+    if (statement_sink and diagnostics)
+      emit_diagnostic(true, message);
+    else if (diagnostics)
+      diagnostics->push_back(diagnostic(diagnostic::severity::error, message));
+    else
+      throw message;
+  }
+
+  void collection::report_warning(const std::string& message) {
+    if (statement_sink)
+      emit_diagnostic(false, message);
+    else if (diagnostics)
+      diagnostics->push_back(diagnostic(diagnostic::severity::warning, message));
+    else
+      std::cerr << "warning: " << message << std::endl;
+  }
+
+  void collection::emit_definition(key_value_definition&& def) {
+    if (statement_sink) {
+      parsed_statement s;
+      s.k = parsed_statement::kind::definition;
+      s.definitions.push_back(std::move(def));
+      statement_sink->push_back(std::move(s));
+    } else {
+      set_global_definition(std::move(def));
+    }
+  }
+
+  void collection::emit_group(std::vector<key_value_definition>&& defs) {
+    if (statement_sink) {
+      parsed_statement s;
+      s.k = parsed_statement::kind::group;
+      s.definitions = std::move(defs);
+      statement_sink->push_back(std::move(s));
+    } else {
+      set_key_value_group(std::move(defs));
+    }
+  }
+
+  void collection::emit_import(const std::string& filename) {
+    if (statement_sink) {
+      parsed_statement s;
+      s.k = parsed_statement::kind::import;
+      s.filename = filename;
+      s.path = resolve_import_path(filename);
+      loader->schedule(s.path);
+      statement_sink->push_back(std::move(s));
+    } else {
+      read_from_file(filename);
+    }
+  }
+
+  void collection::emit_variants(const std::vector<std::string>& filenames, const std::string& coordinates) {
+    parsed_statement s;
+    s.k = parsed_statement::kind::variants;
+    s.variant_filenames = filenames;
+    for (const auto& filename: filenames)
+      s.variant_paths.push_back(resolve_import_path(filename));
+    s.coordinates = coordinates;
+
+    if (statement_sink) {
+      for (const auto& path: s.variant_paths)
+        loader->schedule(path);
+      statement_sink->push_back(std::move(s));
+    } else {
+      // the variants are parsed together, so that a file they all
+      // import is parsed once
+      import_loader l(*this);
+      for (const auto& path: s.variant_paths)
+        l.schedule(path);
+      l.load(s.variant_paths.front());
+
+      std::vector<std::string> import_stack;
+      for (const auto& path: s.variant_paths)
+        if (l.get(path).is_accessible)
+          l.count_applications(path, import_stack);
+      apply_variants(l, s, import_stack);
+    }
+  }
+
+  void collection::emit_diagnostic(bool is_error, const std::string& message) {
+    parsed_statement s;
+    s.k = is_error ? parsed_statement::kind::error : parsed_statement::kind::warning;
+    s.message = message;
+    statement_sink->push_back(std::move(s));
+  }
+
+  void collection::read_with_parallel_imports(const std::string& filename, const std::string& path) {
+    import_loader l(*this);
+    l.load(path);
+
+    if (not l.get(path).is_accessible)
+      throw std::string("file '" + filename + "' is not accessible");
+
+    std::vector<std::string> import_stack;
+    l.count_applications(path, import_stack);
+    apply_parsed_file(l, path, import_stack);
+    compact_dimensions();
+  }
+
+  void collection::apply_parsed_file(import_loader& l, const std::string& path,
+                                     std::vector<std::string>& import_stack) {
+    if (std::find(import_stack.begin(), import_stack.end(), path) != import_stack.end())
+      throw std::string("circular import of the file '" + path + "'");
+    import_stack.push_back(path);
+
+    parsed_file& file(l.get(path));
+    const bool is_last_application(--file.application_number == 0);
+    for (auto& s: file.statements) {
+      if (s.k == parsed_statement::kind::failure) {
+        import_stack.pop_back();
+        std::rethrow_exception(s.exception);
+      }
+
+      try {
+        switch (s.k) {
+        case parsed_statement::kind::definition:
+          if (is_last_application)
+            set_global_definition(std::move(s.definitions.front()));
+          else
+            set_global_definition(s.definitions.front().clone());
+          break;
+
+        case parsed_statement::kind::group:
+          if (is_last_application) {
+            set_key_value_group(std::move(s.definitions));
+          } else {
+            std::vector<key_value_definition> defs;
+            for (const auto& def: s.definitions)
+              defs.push_back(def.clone());
+            set_key_value_group(std::move(defs));
+          }
+          break;
+
+        case parsed_statement::kind::import:
+          if (not l.get(s.path).is_accessible)
+            throw std::string("file '" + s.filename + "' is not accessible");
+          apply_parsed_file(l, s.path, import_stack);
+          break;
+
+        case parsed_statement::kind::variants:
+          apply_variants(l, s, import_stack);
+          break;
+
+        case parsed_statement::kind::error:
+          report_error(s.message);
+          break;
+
+        case parsed_statement::kind::warning:
+          report_warning(s.message);
+          break;
+
+        case parsed_statement::kind::failure:
+          break;
+        }
+      }
+      catch (const std::string& e) {
+        if (not diagnostics) {
+          import_stack.pop_back();
+          throw;
+        }
+        report_error(e);
+      }
+    }
+
+    import_stack.pop_back();
+  }
+
+  void collection::apply_variants(import_loader& l, const parsed_statement& s,
+                                  std::vector<std::string>& import_stack) {
+    if (l.is_applying_variants())
+      throw std::string("variants imported at " + s.coordinates + " by a variant, variants cannot be nested");
+
+    // each variant is applied once, to a collection of its own
+    std::vector<collection> variants(s.variant_paths.size());
+    l.set_applying_variants(true);
+    try {
+      for (std::size_t i(0); i < variants.size(); ++i) {
+        if (not l.get(s.variant_paths[i]).is_accessible)
+          throw std::string("file '" + s.variant_filenames[i] + "' is not accessible");
+
+        variants[i].lazy_loading = lazy_loading;
+        variants[i].diagnostics = diagnostics;
+        variants[i].variant_base = this;
+        variants[i].apply_parsed_file(l, s.variant_paths[i], import_stack);
+      }
+    }
+    catch (...) {
+      l.set_applying_variants(false);
+      throw;
+    }
+    l.set_applying_variants(false);
+
+    // value of each key in each variant, a variant which does not
+    // define a key keeping its value from before the import
+    std::map<std::string, std::vector<const basic_value*> > values;
+    for (std::size_t i(0); i < variants.size(); ++i)
+      for (const auto& kv: variants[i].key_value) {
+        if (kv.second.get_value_number() != 1)
+          throw string_builder("the variant '")(s.variant_filenames[i])("' imported at ")(s.coordinates)
+            (" sweeps the key '")(kv.first)("', a variant can only give single values").str();
+
+        variants[i].materialize(kv.second);
+        std::vector<const basic_value*>& key_values(values[kv.first]);
+        key_values.resize(variants.size(), nullptr);
+        key_values[i] = kv.second.values.front();
+      }
+
+    std::vector<key_value_definition> group;
+    for (auto& kv: values) {
+      const multi_value* base(find_key(kv.first));
+      for (std::size_t i(0); i < variants.size(); ++i) {
+        if (kv.second[i])
+          continue;
+
+        if (not base)
+          throw string_builder("the key '")(kv.first)("' is defined by a variant imported at ")(s.coordinates)
+            (" but neither by the variant '")(s.variant_filenames[i])("' nor before the import").str();
+        if (base->get_value_number() != 1)
+          throw string_builder("the key '")(kv.first)("' is swept before the variants imported at ")(s.coordinates)
+            (" and not defined by the variant '")(s.variant_filenames[i])("'").str();
+
+        materialize(*base);
+        kv.second[i] = base->values.front();
+      }
+
+      // the variants overlay the keys defined before the import, which
+      // is neither a redefinition to warn about nor an error
+      key_value_definition def;
+      def.is_overriding = base != nullptr;
+      def.key = kv.first;
+      def.coordinates = s.coordinates;
+
+      const basic_value* first(kv.second.front());
+      if (std::all_of(kv.second.begin(), kv.second.end(),
+                      [first](const basic_value* v) { return is_same_value(v, first); })) {
+        // the same in every variant, stored once out of the dimension
+        def.mv.append_value(first->clone());
+        set_global_definition(std::move(def));
+      } else {
+        for (const auto v: kv.second)
+          def.mv.append_value(v->clone());
+        group.push_back(std::move(def));
+      }
+    }
+
+    // the keys which differ share the dimension of the variants
+    set_key_value_group(std::move(group));
+  }
+
+  bool collection::parser::is_statement_start(token_source<token_type>& ts) {
+    token_type* t(ts.peek());
+    switch (t->symbol) {
+    case symbol::eoi:
+    case symbol::import:
+    case symbol::override_keyword:
+    case symbol::lbracket:
+    case symbol::rbrace:
+      return true;
+    case symbol::lparen: {
+      // a key list followed by an equal, and not a row of values
+      std::size_t n(1);
+      while (ts.peek(n)->symbol == symbol::key and ts.peek(n + 1)->symbol == symbol::comma)
+        n += 2;
+      return ts.peek(n)->symbol == symbol::key and ts.peek(n + 1)->symbol == symbol::rparen
+        and ts.peek(n + 2)->symbol == symbol::equal;
+    }
+    case symbol::key:
+      return ts.peek(1)->symbol == symbol::equal or ts.peek(1)->symbol == symbol::lbrace;
+    default:
+      return false;
+    }
+  }
+
+  void collection::parser::skip_to_next_statement(token_source<token_type>& ts, std::size_t failing_position) {
+    if (ts.get_position() == failing_position and ts.peek()->symbol != symbol::eoi)
+      delete ts.get();
+
+    while (not is_statement_start(ts)) {
+      const bool closing_group(ts.peek()->symbol == symbol::rbracket);
+      delete ts.get();
+      if (closing_group)
+        break;
+    }
+  }
+
+  std::string collection::parser::enum_item_token_to_enum_item(token_type* t) {
+    // remove the leading '#'
+    std::string str(t->value.substr(1, t->value.size() - 1));
+    return str;
+  }
+
+  std::string collection::parser::string_token_to_string(token_type* t) {
+    // remove the quoting characters and escaped sequences
+    std::string str(t->value.substr(1, t->value.size() - 2));
+
+    std::string::iterator i(str.begin());
+    while (i != str.end()) {
+      if (*i == '\\') {
+        i = str.erase(i);
+        if (i != str.end())
+          ++i;
+      } else {
+        ++i;
+      }
+    }
+    
+    return str;
+  }
+
+  void collection::parser::parse_parameter_list(token_source<token_type>& ts) {
+    parse_statement_list(ts, symbol::eoi);
+  }
+
+  void collection::parser::parse_statement_list(token_source<token_type>& ts, symbol end) {
+    token_type* t(ts.peek());
+
+    while (t->symbol != end and t->symbol != symbol::eoi) {
+      const std::size_t position(ts.get_position());
+      try {
+        switch (t->symbol) {
+        case symbol::key:
+          if (ts.peek(1)->symbol == symbol::lbrace)
+            parse_namespace(ts);
+          else
+            parse_global_definition(ts);
+          break;
+        case symbol::override_keyword:
+          if (ts.peek(1)->symbol == symbol::lparen)
+            parse_point_table(ts);
+          else
+            parse_global_definition(ts);
+          break;
+        case symbol::lbracket:
+          parse_group_definition(ts);
+          break;
+        case symbol::lparen:
+          parse_point_table(ts);
+          break;
+        case symbol::import:
+          if (c.key_prefix.size())
+            throw string_builder("import statement at ")(t->render_coordinates())
+              (" inside the namespace '")(c.key_prefix.substr(0, c.key_prefix.size() - 1))
+              ("', imports are only allowed at the top level").str();
+          parse_import_statment(ts);
+          break;
+        default:
+          throw string_builder("unexpected ")
+            (t->symbol)
+            (" token at ")
+            (t->render_coordinates())
+            (" instead of a ")
+            (symbol::key)
+            (" token").str();
+        }
+      }
+      catch (const std::string& e) {
+        if (not c.diagnostics)
+          throw;
+        c.report_error(e);
+        skip_to_next_statement(ts, position);
+      }
+      t = ts.peek();
+    }
+  }
+
+  void collection::parser::parse_namespace(token_source<token_type>& ts) {
+    token_type
+      *name_token(ts.get()),
+      *lbrace_token(ts.get());
+
+    const std::size_t prefix_size(c.key_prefix.size());
+    c.key_prefix += name_token->value + ".";
+    try {
+      parse_statement_list(ts, symbol::rbrace);
+    } catch (...) {
+      c.key_prefix.resize(prefix_size);
+      throw;
+    }
+    c.key_prefix.resize(prefix_size);
+
+    if (ts.peek()->symbol != symbol::rbrace)
+      throw string_builder("unterminated namespace '")(name_token->value)
+        ("' opened at ")(lbrace_token->render_coordinates()).str();
+
+    delete ts.get();
+    delete name_token;
+    delete lbrace_token;
+  }
+
+  void collection::parser::parse_group_definition(token_source<token_type>& ts) {
+    token_type* lbracket_token(ts.get());
+    if (lbracket_token->symbol != symbol::lbracket)
+      throw string_builder("unexpected ")
+        (lbracket_token->symbol)
+        (" token at ")
+        (lbracket_token->render_coordinates())
+        (" instead of a ")
+        (symbol::lbracket)
+        (" token").str();
+
+    std::vector<key_value_definition> defs;
+    bool has_error(false);
+
+    bool done(false);
+    while (not done) {
+      token_type* current_token(ts.peek());
+      const symbol current_symbol(current_token->symbol);
+      const std::size_t current_position(ts.get_position());
+
+      try {
+        switch (current_token->symbol) {
+        case symbol::override_keyword:
+        case symbol::key:
+          defs.push_back(parse_key_value_definition(ts));
+          break;
+
+        case symbol::rbracket:
+          delete ts.get();
+          done = true;
+          break;
+
+        default:
+          throw string_builder("unexpected ")
+            (current_token->symbol)
+            (" token at ")
+            (current_token->render_coordinates()).str();
+        }
+      }
+      catch (const std::string& e) {
+        if (not c.diagnostics or current_symbol == symbol::eoi)
+          throw;
+        c.report_error(e);
+        has_error = true;
+
+        // resume at the next definition of the group
+        if (ts.get_position() == current_position)
+          delete ts.get();
+        while (not is_statement_start(ts) and ts.peek()->symbol != symbol::rbracket)
+          delete ts.get();
+        if (ts.peek()->symbol == symbol::eoi)
+          throw string_builder("unterminated group definition at ")
+            (lbracket_token->render_coordinates()).str();
+      }
+    }
+
+    if (not has_error)
+      c.emit_group(std::move(defs));
+    
+    delete lbracket_token;
+  }
+
+  void collection::parser::parse_point_table(token_source<token_type>& ts) {
+    bool is_overriding(false);
+    if (ts.peek()->symbol == symbol::override_keyword) {
+      is_overriding = true;
+      delete ts.get();
+    }
+
+    const std::vector<std::string> keys(parse_key_list(ts));
+
+    token_type* equal_token(ts.get());
+    if (equal_token->symbol != symbol::equal)
+      throw string_builder("unexpected ")
+        (equal_token->symbol)
+        (" token at ")
+        (equal_token->render_coordinates())
+        (" instead of a ")(symbol::equal).str();
+
+    std::vector<key_value_definition> defs(keys.size());
+    for (std::size_t k(0); k < keys.size(); ++k) {
+      defs[k].is_overriding = is_overriding;
+      defs[k].key = c.key_prefix + keys[k];
+      defs[k].coordinates = equal_token->render_coordinates();
+    }
+
+    bool done(false);
+    while (not done) {
+      token_type* lparen_token(ts.get());
+      if (lparen_token->symbol != symbol::lparen)
+        throw string_builder("unexpected ")
+          (lparen_token->symbol)
+          (" token at ")
+          (lparen_token->render_coordinates())
+          (" instead of a ")(symbol::lparen).str();
+
+      for (std::size_t k(0); k < keys.size(); ++k) {
+        if (k > 0) {
+          token_type* comma_token(ts.get());
+          if (comma_token->symbol != symbol::comma)
+            throw string_builder("the row at ")(lparen_token->render_coordinates())
+              (" has ")(k)(" values instead of ")(keys.size()).str();
+          delete comma_token;
+        }
+        defs[k].mv.append_value(parse_value(ts));
+      }
+
+      token_type* rparen_token(ts.get());
+      if (rparen_token->symbol != symbol::rparen)
+        throw string_builder("the row at ")(lparen_token->render_coordinates())
+          (" has more values than the ")(keys.size())(" keys").str();
+
+      delete lparen_token;
+      delete rparen_token;
+
+      if (ts.peek()->symbol == symbol::comma)
+        delete ts.get();
+      else
+        done = true;
+    }
+
+    c.emit_group(std::move(defs));
+
+    delete equal_token;
+  }
+
+  std::vector<std::string> collection::parser::parse_key_list(token_source<token_type>& ts) {
+    token_type* lparen_token(ts.get());
+    if (lparen_token->symbol != symbol::lparen)
+      throw string_builder("unexpected ")
+        (lparen_token->symbol)
+        (" token at ")
+        (lparen_token->render_coordinates())
+        (" instead of a ")(symbol::lparen).str();
+
+    std::vector<std::string> keys;
+    bool done(false);
+    while (not done) {
+      token_type* key_token(ts.get());
+      if (key_token->symbol != symbol::key)
+        throw string_builder("unexpected ")
+          (key_token->symbol)
+          (" token at ")
+          (key_token->render_coordinates())
+          (" instead of a ")(symbol::key).str();
+
+      if (std::find(keys.begin(), keys.end(), key_token->value) != keys.end())
+        throw string_builder("the key '")(key_token->value)("' is repeated in the key list at ")
+          (lparen_token->render_coordinates()).str();
+      keys.push_back(key_token->value);
+      delete key_token;
+
+      token_type* separator_token(ts.get());
+      if (separator_token->symbol == symbol::rparen)
+        done = true;
+      else if (separator_token->symbol != symbol::comma)
+        throw string_builder("unexpected ")
+          (separator_token->symbol)
+          (" token at ")
+          (separator_token->render_coordinates())
+          (" instead of a ")(symbol::rparen).str();
+      delete separator_token;
+    }
+
+    delete lparen_token;
+    return keys;
+  }
+
+  void collection::parser::parse_global_definition(token_source<token_type>& ts) {
+    c.emit_definition(parse_key_value_definition(ts));
+  }
+
+  collection::key_value_definition collection::parser::parse_key_value_definition(token_source<token_type>& ts) {
+    key_value_definition def;
+    def.is_overriding = false;
+    
+    token_type *override_keyword_token(ts.peek());
+    if (override_keyword_token->symbol == symbol::override_keyword) {
+      def.is_overriding = true;
+      delete ts.get();
+    }
+
+    
+    token_type
+      *key_token(ts.get()),
+      *equal_token(ts.get());
+
+    if (equal_token->symbol != symbol::equal)
+      throw string_builder("unexpected ")
+        (key_token->symbol)
+        (" token at ")
+        (key_token->render_coordinates())
+        (" instead of a ")
+        (symbol::key).str();
+
+    if (equal_token->symbol != symbol::equal)
+      throw string_builder("unexpected ")
+        (equal_token->symbol)
+        (" token at ")
+        (equal_token->render_coordinates())
+        (" instead of a ")
+        (symbol::equal).str();
+
+    def.coordinates = equal_token->render_coordinates();
+    def.key = c.key_prefix + key_token->value;
+
+    token_type* value_token(ts.peek());
+    switch (value_token->symbol) {
+    case symbol::integer:
+    case symbol::real:
+    case symbol::boolean:
+    case symbol::string:
+    case symbol::enum_item:
+    case symbol::key:
+      def.mv = parse_value_list(ts);
+      break;
+      
+    default:
+      throw string_builder("unexpected ")
+        (value_token->symbol)
+        (" token at ")
+        (value_token->render_coordinates()).str();
+    }
+
+    delete key_token;
+    delete equal_token;
+
+    return def;
+  }
+
+  collection::multi_value collection::parser::parse_value_list(token_source<token_type>& ts) {
+    multi_value v;
+    
+    bool done(false);
+    while (not done) {
+      v.append_value(parse_value(ts));
+      
+      token_type* comma_token(ts.peek());
+      if (comma_token->symbol == symbol::comma)
+        delete ts.get();
+      else
+        done = true;
+    }
+
+    return v;
+  }
+
+  basic_value* collection::parser::parse_value(token_source<token_type>& ts) {
+    token_type* current_token(ts.peek());
+
+    switch (current_token->symbol) {
+    case symbol::integer:
+      return parse_integer_value(ts);
+
+    case symbol::real:
+      return parse_real_value(ts);
+
+    case symbol::boolean:
+      return parse_boolean_value(ts);
+
+    case symbol::string:
+      return parse_string_value(ts);
+
+    case symbol::enum_item:
+      return parse_enum_item(ts);
+
+    case symbol::key:
+      return parse_key_value(ts);
+
+    default:
+      throw string_builder("unexpected ")
+        (current_token->symbol)
+        (" token at ")
+        (current_token->render_coordinates()).str();
+    }
+  }
+
+  basic_value* collection::parser::parse_integer_value(token_source<token_type>& ts) {
+    token_type* integer_token(ts.get());
+    if (integer_token->symbol != symbol::integer)
+      throw string_builder("unexpected ")
+        (integer_token->symbol)
+        (" token at ")
+        (integer_token->render_coordinates())
+        (" instead of a ")(symbol::integer).str();
+
+    // out of range values fail like malformed ones
+    std::size_t pos(0);
+    int i(0);
+    try {
+      i = std::stoi(integer_token->value, &pos);
+    }
+    catch (const std::logic_error&) {
+      pos = 0;
+    }
+    if (pos != integer_token->value.size())
+      throw string_builder("failed to convert ")
+        (integer_token->symbol)
+        (" token at ")
+        (integer_token->render_coordinates())
+        (" to an integer value ").str();
+    
+    delete integer_token;
+
+    return new ::parameter::value<int>(i);
+  }
+
+  basic_value* collection::parser::parse_real_value(token_source<token_type>& ts) {
+    token_type* real_token(ts.get());
+    if (real_token->symbol != symbol::real)
+      throw string_builder("unexpected ")
+        (real_token->symbol)
+        (" token at ")
+        (real_token->render_coordinates())
+        (" instead of a ")
+        (symbol::real).str();
+
+    std::size_t pos(0);
+    double d(0.);
+    try {
+      d = std::stod(real_token->value, &pos);
+    }
+    catch (const std::logic_error&) {
+      pos = 0;
+    }
+    if (pos != real_token->value.size())
+      throw string_builder("failed to convert ")
+        (real_token->symbol)
+        (" token at ")
+        (real_token->render_coordinates())
+        (" to an real value ").str();
+    
+    delete real_token;
+
+    return new ::parameter::value<double>(d);
+  }
+
+  basic_value* collection::parser::parse_string_value(token_source<token_type>& ts) {
+    token_type* string_token(ts.get());
+    if (string_token->symbol != symbol::string)
+      throw string_builder("unexpected ")
+        (string_token->symbol)
+        (" token at ")
+        (string_token->render_coordinates())
+        (" instead of a ")(symbol::real).str();
+
+    basic_value* v(new ::parameter::value<std::string>(string_token_to_string(string_token)));
+    
+    delete string_token;
+
+    return v;
+  }
+
+  basic_value* collection::parser::parse_enum_item(token_source<token_type>& ts) {
+    token_type* enum_item_token(ts.get());
+    if (enum_item_token->symbol != symbol::enum_item)
+      throw string_builder("unexpected ")
+        (enum_item_token->symbol)
+        (" token at ")
+        (enum_item_token->render_coordinates())
+        (" instead of a ")(symbol::real).str();
+
+    basic_value* v(new ::parameter::enum_value(enum_item_token_to_enum_item(enum_item_token)));
+    
+    delete enum_item_token;
+
+    return v;
+  }
+
+  basic_value* collection::parser::parse_boolean_value(token_source<token_type>& ts) {
+    token_type* boolean_token(ts.get());
+    if (boolean_token->symbol != symbol::boolean)
+      throw string_builder("unexpected ")
+        (boolean_token->symbol)
+        (" token at ")
+        (boolean_token->render_coordinates())
+        (" instead of a ")(symbol::real).str();
+
+    basic_value* v(nullptr);
+    if (boolean_token->value == "on" or
+        boolean_token->value == "yes" or
+        boolean_token->value == "true")
+      v = new ::parameter::value<bool>(true);
+    else if (boolean_token->value == "off" or
+             boolean_token->value == "no" or
+             boolean_token->value == "false")
+      v = new ::parameter::value<bool>(false);
+    else
+      throw string_builder("failed to convert ")
+        (boolean_token->symbol)
+        (" token at ")
+        (boolean_token->render_coordinates())
+        (" to an real value ").str();
+    
+    delete boolean_token;
+
+    return v;
+  }
+
+  basic_value* collection::parser::parse_key_value(token_source<token_type>& ts) {
+    token_type* key_token(ts.get());
+    if (key_token->symbol != symbol::key)
+      throw string_builder("unexpected ")
+        (key_token->symbol)(" token at ")
+        (key_token->render_coordinates())(" instead of a ")(symbol::key).str();
+
+    basic_value* v(new ::parameter::value_ref(key_token->value));
+
+    delete key_token;
+
+    return v;
+  }
+
+  void collection::parser::parse_import_statment(token_source<token_type>& ts) {
+    token_type* import_token(ts.get());
+
+    if (import_token->symbol != symbol::import)
+      throw string_builder("unexpected ")
+        (import_token->symbol)
+        (" token at ")
+        (import_token->render_coordinates())
+        (" instead of a ")(symbol::import).str();
+
+    if (ts.peek()->symbol == symbol::enum_item) {
+      parse_table_import(ts, import_token);
+      return;
+    }
+
+    std::vector<std::string> filenames;
+    while (true) {
+      token_type* string_token(ts.get());
+
+      if (string_token->symbol != symbol::string)
+        throw string_builder("unexpected ")
+          (string_token->symbol)
+          (" token at ")
+          (string_token->render_coordinates())
+          (" instead of a ")(symbol::string).str();
+
+      filenames.push_back(string_token_to_string(string_token));
+      delete string_token;
+
+      if (ts.peek()->symbol != symbol::comma)
+        break;
+      delete ts.get();
+    }
+
+    // several files are the variants of a dimension
+    if (filenames.size() == 1)
+      c.emit_import(filenames.front());
+    else
+      c.emit_variants(filenames, import_token->render_coordinates());
+
+    delete import_token;
+  }
+
+  void collection::parser::parse_table_import(token_source<token_type>& ts, token_type* import_token) {
+    token_type
+      *format_token(ts.get()),
+      *string_token(ts.get()),
+      *equal_token(ts.get());
+
+    if (format_token->symbol != symbol::enum_item)
+      throw string_builder("unexpected ")
+        (format_token->symbol)
+        (" token at ")
+        (format_token->render_coordinates())
+        (" instead of a ")(symbol::enum_item).str();
+
+    const std::string format(enum_item_token_to_enum_item(format_token));
+    if (format != "csv" and format != "binary")
+      throw string_builder("unknown table format '")(format)("' at ")
+        (format_token->render_coordinates())(", expected #csv or #binary").str();
+
+    if (string_token->symbol != symbol::string)
+      throw string_builder("unexpected ")
+        (string_token->symbol)
+        (" token at ")
+        (string_token->render_coordinates())
+        (" instead of a ")(symbol::string).str();
+
+    if (equal_token->symbol != symbol::equal)
+      throw string_builder("unexpected ")
+        (equal_token->symbol)
+        (" token at ")
+        (equal_token->render_coordinates())
+        (" instead of a ")(symbol::equal).str();
+
+    // either a key prefix or the keys of a point table
+    std::vector<std::string> keys;
+    token_type* prefix_token(nullptr);
+    if (ts.peek()->symbol == symbol::lparen) {
+      keys = parse_key_list(ts);
+    } else {
+      prefix_token = ts.get();
+      if (prefix_token->symbol != symbol::key)
+        throw string_builder("unexpected ")
+          (prefix_token->symbol)
+          (" token at ")
+          (prefix_token->render_coordinates())
+          (" instead of a ")(symbol::key).str();
+    }
+
+    std::vector<table_column_declaration> declarations;
+    if (is_column_declaration_list(ts)) {
+      delete ts.get();
+      while (ts.peek()->symbol != symbol::rbracket)
+        declarations.push_back(parse_column_declaration(ts));
+      delete ts.get();
+    }
+
+    const std::string path(c.resolve_import_path(string_token_to_string(string_token)));
+    const std::vector<table_column> columns(format == "csv" ?
+                                            read_csv_table(path, declarations) :
+                                            map_binary_table(path, declarations));
+
+    static_assert(sizeof(int) == sizeof(std::int32_t), "integer columns are stored as int32");
+    if (keys.size()) {
+      // a key without values cannot be read at any point
+      if (columns.empty() or columns.front().size == 0)
+        throw string_builder("the table '")(path)("' imported at ")(import_token->render_coordinates())
+          (" has no rows to define the keys of a point table").str();
+
+      std::vector<key_value_definition> defs;
+      for (const auto& key: keys) {
+        const auto column(std::find_if(columns.begin(), columns.end(),
+                                       [&key](const table_column& tc) { return tc.name == key; }));
+        if (column == columns.end())
+          throw string_builder("the table '")(path)("' has no column named '")(key)("' at ")
+            (import_token->render_coordinates()).str();
+
+        key_value_definition def;
+        def.is_overriding = false;
+        def.key = key;
+        def.coordinates = import_token->render_coordinates();
+        def.mv.values.reserve(column->size);
+        for (std::size_t i(0); i < column->size; ++i)
+          if (column->t == table_column::type::integer)
+            def.mv.append_value(new ::parameter::value<int>(static_cast<const int*>(column->data)[i]));
+          else
+            def.mv.append_value(new ::parameter::value<double>(static_cast<const double*>(column->data)[i]));
+        defs.push_back(std::move(def));
+      }
+      c.emit_group(std::move(defs));
+    } else {
+      for (const auto& column: columns) {
+        key_value_definition def;
+        def.is_overriding = false;
+        def.key = prefix_token->value + "-" + column.name;
+        def.coordinates = import_token->render_coordinates();
+        def.mv = multi_value(dimension_table::no_dimension,
+                             column.t == table_column::type::integer ?
+                             static_cast<basic_value*>(new column_value<int>(column)) :
+                             static_cast<basic_value*>(new column_value<double>(column)));
+        c.emit_definition(std::move(def));
+      }
+    }
+
+    delete import_token;
+    delete format_token;
+    delete string_token;
+    delete equal_token;
+    delete prefix_token;
+  }
+
+  bool collection::parser::is_column_declaration_list(token_source<token_type>& ts) {
+    // 'name: #type' items naming column types up to the closing
+    // bracket, anything else is a group definition following the import
+    if (ts.peek()->symbol != symbol::lbracket)
+      return false;
+
+    std::size_t n(1);
+    while (ts.peek(n)->symbol == symbol::key
+           and ts.peek(n + 1)->symbol == symbol::equal
+           and ts.peek(n + 2)->symbol == symbol::enum_item
+           and (ts.peek(n + 2)->value == "#integer" or ts.peek(n + 2)->value == "#real"))
+      n += 3;
+    return n > 1 and ts.peek(n)->symbol == symbol::rbracket;
+  }
+
+  table_column_declaration collection::parser::parse_column_declaration(token_source<token_type>& ts) {
+    token_type
+      *name_token(ts.get()),
+      *equal_token(ts.get()),
+      *type_token(ts.get());
+
+    if (name_token->symbol != symbol::key)
+      throw string_builder("unexpected ")
+        (name_token->symbol)
+        (" token at ")
+        (name_token->render_coordinates())
+        (" instead of a ")(symbol::key).str();
+
+    if (equal_token->symbol != symbol::equal)
+      throw string_builder("unexpected ")
+        (equal_token->symbol)
+        (" token at ")
+        (equal_token->render_coordinates())
+        (" instead of a ")(symbol::equal).str();
+
+    if (type_token->symbol != symbol::enum_item)
+      throw string_builder("unexpected ")
+        (type_token->symbol)
+        (" token at ")
+        (type_token->render_coordinates())
+        (" instead of a ")(symbol::enum_item).str();
+
+    table_column_declaration d;
+    d.name = name_token->value;
+
+    const std::string type(enum_item_token_to_enum_item(type_token));
+    if (type == "integer")
+      d.t = table_column::type::integer;
+    else if (type == "real")
+      d.t = table_column::type::real;
+    else
+      throw string_builder("unknown column type '")(type)("' at ")
+        (type_token->render_coordinates())(", expected #integer or #real").str();
+
+    delete name_token;
+    delete equal_token;
+    delete type_token;
+
+    return d;
+  }
+
+}
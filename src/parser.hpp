@@ -0,0 +1,538 @@
+#ifndef PARAMETER_PARSER_H
+#define PARAMETER_PARSER_H
+
+/*
+ * Parser of the parameter files, private to the library: only the
+ * translation units of the library include it, so that the lexer and
+ * the parser are not compiled again by every user of parameter.hpp.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <deque>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <typeinfo>
+
+#include <unistd.h>
+
+#include <lexer/lexer.hpp>
+
+#include "parameter.hpp"
+#include "table.hpp"
+#include "lazy.hpp"
+#include "shared.hpp"
+
+namespace parameter {
+
+  class resource_locator {
+  public:
+    resource_locator(const std::string& path)
+      : separator('/'), is_absolute(false) {
+      if (path[0] == '/')
+        is_absolute = true;
+      components = split(path, separator);
+    }
+    
+    std::string resource_name() const { return components.back(); }
+    
+    resource_locator resource_path() const {
+      if (components.size() == 1)
+        return resource_locator("./");
+      else
+        return resource_locator(components.begin(), components.end() - 1, is_absolute);
+    }
+    
+    std::string to_string() const {
+      std::string str;
+
+      if (is_absolute) str += separator;
+
+      for (std::size_t i(0); i < components.size() - 1; ++i) {
+        str += components[i];
+        str += '/';
+      }
+      str += components.back();
+
+      return str;
+    }
+
+  private:
+    std::vector<std::string> components;
+    char separator;
+    bool is_absolute;
+
+  private:
+    resource_locator(std::vector<std::string>::const_iterator begin,
+                     std::vector<std::string>::const_iterator end,
+                     bool is_absolute)
+      : components(begin, end), separator('/'), is_absolute(is_absolute) {}
+
+    static std::vector<std::string> split(const std::string& str, char separator) {
+      std::vector<std::string> components;
+      std::string c;
+      
+      std::size_t i(0);
+      while (i < str.size()) {
+        if (str[i] == separator) {
+          if (c.size())
+            components.push_back(c);
+          c.clear();
+          i += 1;
+        } else {
+          c += str[i];
+          i += 1;
+        }
+      }
+      
+      if (c.size())
+        components.push_back(c);
+
+      return components;
+    }
+  };
+
+  inline
+  resource_locator get_current_working_directory() {
+    std::vector<char> buffer(255);
+    char* b(&buffer[0]);
+    while (getcwd(b, buffer.size()) == nullptr)
+      buffer.resize(buffer.size() * 2);
+    return resource_locator(std::string(b));
+  }
+
+  inline
+  void change_directory(resource_locator l) {
+    std::string path(l.to_string());
+    if (path != ".") {
+
+      int res(chdir(path.c_str()));
+
+      if (res != 0) {
+        switch (errno) {
+        case EACCES:
+          throw std::string("chdir error EACCES");
+        case EFAULT:
+          throw std::string("chdir error EFAULT");
+        case EIO:
+          throw std::string("chdir error EIO");
+        case ELOOP:
+          throw std::string("chdir error ELOOP");
+        case ENAMETOOLONG:
+          throw std::string("chdir error ENAMETOOLONG");
+        case ENOENT:
+          throw std::string("chdir error ENOENT");
+        case ENOMEM:
+          throw std::string("chdir error ENOMEM");
+        case ENOTDIR:
+          throw std::string("chdir error ENOTDIR");
+        default:
+          throw std::string("chdir unknown error");
+        }
+      }
+    }
+  }
+    
+  /*
+   * Error of the lexer, which cannot resume after it: the parse of the
+   * file ends instead of skipping to the next statement.
+   */
+  struct lexical_error {
+    std::string message;
+  };
+
+  template<typename token_type>
+  class token_source {
+  public:
+    token_source(regex_lexer<token_type>* l)
+      : lex(l), position(0) { lookahead.push_back(next()); }
+
+    ~token_source() {
+      for (auto t: lookahead)
+        delete t;
+    }
+    
+    /*
+     * The following token is read before the current one is taken, so
+     * that the lookahead is never empty, even when the lexer throws.
+     */
+    token_type* get() {
+      if (lookahead.size() == 1)
+        lookahead.push_back(next());
+      token_type* c(lookahead.front());
+      lookahead.pop_front();
+      position += 1;
+      return c;
+    }
+    
+    token_type* peek() {
+      return lookahead.front();
+    }
+
+    /*
+     * peek(0) is equivalent to peek(). The caller must not look past the
+     * end of input token.
+     */
+    token_type* peek(std::size_t n) {
+      while (lookahead.size() <= n)
+        lookahead.push_back(next());
+      return lookahead[n];
+    }
+
+    /*
+     * Number of tokens taken by get, which identifies the token at the
+     * front even once an earlier token was deleted and its address
+     * reused.
+     */
+    std::size_t get_position() const { return position; }
+
+  private:
+    regex_lexer<token_type>* lex;
+    std::deque<token_type*> lookahead;
+    std::size_t position;
+
+  private:
+    token_type* next() {
+      try {
+        return lex->get();
+      }
+      catch (const std::string& e) {
+        throw lexical_error{e};
+      }
+    }
+  };
+
+  
+  enum class symbol {
+    eoi, equal, comma, value,
+    enum_item,
+    string,
+    integer,
+    real,
+    boolean,
+    import,
+    lbracket, rbracket,
+    lbrace, rbrace,
+    lparen, rparen,
+    override_keyword,
+    key
+  };
+
+  using symbol_type = symbol;
+  using token_type = token<symbol_type>;
+
+  
+  std::ostream& operator<<(std::ostream& stream, symbol s);
+  symbol to_symbol(lazy_token::kind k);
+  regex_lexer<token_type> build_lexer();
+
+  /*
+   * Whether the lazy scanner splits a probe text in the same tokens as
+   * the lexer, with the same coordinates. The ties between the rules
+   * and the rendering of the coordinates belong to the lexer library,
+   * and the lazy scanner is not used if they differ. The probe runs
+   * once per process, when lazy loading is first enabled.
+   */
+  bool lazy_scanner_matches_lexer();
+
+  /*
+   * Convert a value token located by the lazy scanner, as the parser
+   * converts the tokens of the lexer.
+   */
+  basic_value* convert_lazy_token(const lazy_source& source, const lazy_token& t);
+
+  /*
+   * Whether two values, as written in the files, are the same: the
+   * reals are compared exactly and the references by key, without
+   * resolving them.
+   */
+  inline bool is_same_value(const basic_value* a, const basic_value* b) {
+    if (typeid(*a) != typeid(*b))
+      return false;
+
+    if (const value<int>* i = dynamic_cast<const value<int>*>(a))
+      return i->get_value() == static_cast<const value<int>*>(b)->get_value();
+    if (const value<double>* d = dynamic_cast<const value<double>*>(a))
+      return d->get_value() == static_cast<const value<double>*>(b)->get_value();
+    if (const value<bool>* bo = dynamic_cast<const value<bool>*>(a))
+      return bo->get_value() == static_cast<const value<bool>*>(b)->get_value();
+    if (const value<std::string>* str = dynamic_cast<const value<std::string>*>(a))
+      return str->get_value() == static_cast<const value<std::string>*>(b)->get_value();
+    if (const enum_value* e = dynamic_cast<const enum_value*>(a))
+      return e->get_token_value() == static_cast<const enum_value*>(b)->get_token_value();
+    if (const value_ref* ref = dynamic_cast<const value_ref*>(a))
+      return ref->get_key() == static_cast<const value_ref*>(b)->get_key();
+    if (const column_value<int>* ci = dynamic_cast<const column_value<int>*>(a)) {
+      const column_value<int>* cj(static_cast<const column_value<int>*>(b));
+      return ci->get_size() == cj->get_size()
+        and std::equal(ci->get_data(), ci->get_data() + ci->get_size(), cj->get_data());
+    }
+    if (const column_value<double>* cr = dynamic_cast<const column_value<double>*>(a)) {
+      const column_value<double>* cs(static_cast<const column_value<double>*>(b));
+      return cr->get_size() == cs->get_size()
+        and std::equal(cr->get_data(), cr->get_data() + cr->get_size(), cs->get_data());
+    }
+    return false;
+  }
+
+  /*
+   * A statement parsed ahead of its application. Diagnostics are
+   * recorded in place, and a failure ends the statement list of the
+   * file with the exception which stopped its parse.
+   */
+  struct collection::parsed_statement {
+    enum class kind { definition, group, import, variants, error, warning, failure };
+
+    kind k;
+    std::vector<key_value_definition> definitions;
+    std::string filename;
+    std::string path;
+    std::vector<std::string> variant_filenames;
+    std::vector<std::string> variant_paths;
+    std::string coordinates;
+    std::string message;
+    std::exception_ptr exception;
+  };
+
+  struct collection::parsed_file {
+    bool is_accessible;
+    std::vector<parsed_statement> statements;
+
+    // applications left, the last one moving the definitions instead of
+    // cloning them
+    std::size_t application_number;
+
+    parsed_file(): is_accessible(true), application_number(0) {}
+  };
+
+  class collection::import_loader {
+  public:
+    import_loader(const collection& c)
+      : lazy_loading(c.lazy_loading), has_diagnostics(c.diagnostics != nullptr),
+        thread_number(std::max(1u, std::thread::hardware_concurrency())), active_number(0),
+        applying_variants(false) {}
+
+    void load(const std::string& path) {
+      schedule(path);
+
+      std::vector<std::thread> threads;
+      for (std::size_t i(1); i < thread_number; ++i)
+        threads.push_back(std::thread(&import_loader::work, this));
+      work();
+      for (auto& t: threads)
+        t.join();
+    }
+
+    void schedule(const std::string& path) {
+      std::lock_guard<std::mutex> lock(m);
+      if (files.count(path))
+        return;
+      files[path] = std::make_shared<parsed_file>();
+      pending.push_back(path);
+      cv.notify_one();
+    }
+
+    const parsed_file& get(const std::string& path) const { return *files.at(path); }
+    parsed_file& get(const std::string& path) { return *files.at(path); }
+
+    /*
+     * Count the applications of each file imported from the path, once
+     * every file is loaded.
+     */
+    void count_applications(const std::string& path, std::vector<std::string>& import_stack) {
+      // a circular import is reported when applying the files
+      if (std::find(import_stack.begin(), import_stack.end(), path) != import_stack.end())
+        return;
+
+      parsed_file& file(get(path));
+      file.application_number += 1;
+
+      import_stack.push_back(path);
+      for (const auto& s: file.statements)
+        if (s.k == parsed_statement::kind::import and get(s.path).is_accessible)
+          count_applications(s.path, import_stack);
+        else if (s.k == parsed_statement::kind::variants)
+          for (const auto& variant_path: s.variant_paths)
+            if (get(variant_path).is_accessible)
+              count_applications(variant_path, import_stack);
+      import_stack.pop_back();
+    }
+
+    /*
+     * Set while the files of variants are applied, in which other
+     * variants are not allowed.
+     */
+    bool is_applying_variants() const { return applying_variants; }
+    void set_applying_variants(bool b) { applying_variants = b; }
+
+  private:
+    const bool lazy_loading;
+    const bool has_diagnostics;
+    const std::size_t thread_number;
+
+    std::mutex m;
+    std::condition_variable cv;
+    std::deque<std::string> pending;
+    std::size_t active_number;
+    std::map<std::string, std::shared_ptr<parsed_file> > files;
+    bool applying_variants;
+
+  private:
+    void work() {
+      std::unique_lock<std::mutex> lock(m);
+      while (true) {
+        cv.wait(lock, [this]() { return pending.size() or active_number == 0; });
+        if (pending.empty())
+          break;
+
+        const std::string path(pending.front());
+        pending.pop_front();
+        parsed_file& file(*files[path]);
+        active_number += 1;
+
+        lock.unlock();
+        parse(path, file);
+        lock.lock();
+
+        active_number -= 1;
+        cv.notify_all();
+      }
+    }
+
+    void parse(const std::string& path, parsed_file& file) {
+      std::ifstream f(path.c_str(), std::ios::in);
+      if (not f) {
+        file.is_accessible = false;
+        return;
+      }
+
+      // each file is parsed by its own collection, in the same modes
+      std::vector<diagnostic> ignored;
+      collection c;
+      c.lazy_loading = lazy_loading;
+      c.diagnostics = has_diagnostics ? &ignored : nullptr;
+      c.statement_sink = &file.statements;
+      c.loader = this;
+
+      try {
+        c.parse_stream(f, path, resource_locator(path).resource_path().to_string());
+      }
+      catch (...) {
+        parsed_statement s;
+        s.k = parsed_statement::kind::failure;
+        s.exception = std::current_exception();
+        file.statements.push_back(std::move(s));
+      }
+    }
+  };
+
+
+  /*
+   * Recursive descent parser of the token stream, applying the
+   * statements to the collection through its emit functions.
+   */
+  class collection::parser {
+  public:
+    parser(collection& c): c(c) {}
+
+    bool is_statement_start(token_source<token_type>& ts);
+
+    /*
+     * Error recovery: skip tokens up to the beginning of the next
+     * statement, or past the closing bracket of a group.
+     */
+    void skip_to_next_statement(token_source<token_type>& ts, std::size_t failing_position);
+
+    std::string enum_item_token_to_enum_item(token_type* t);
+
+    std::string string_token_to_string(token_type* t);
+
+    // FIRST(parameter list) = {key}
+    void parse_parameter_list(token_source<token_type>& ts);
+
+    /*
+     * Parse statements up to the end symbol, which is left in the
+     * token source: eoi for a file, rbrace for a namespace.
+     */
+    void parse_statement_list(token_source<token_type>& ts, symbol end);
+
+    /*
+     * name { statements }: the keys defined by the statements are
+     * prefixed by "name.", namespaces nest.
+     */
+    void parse_namespace(token_source<token_type>& ts);
+
+    void parse_group_definition(token_source<token_type>& ts);
+
+    /*
+     * FIRST(point table) = {lparen, override_keyword}:
+     *
+     *   (solver, tolerance, iterations) = (#cg, 1e-8, 200),
+     *                                     (#gmres, 1e-6, 50)
+     *
+     * Each row is a point, the keys share one dimension like the keys
+     * of a group.
+     */
+    void parse_point_table(token_source<token_type>& ts);
+
+    /*
+     * ( key, key, ... ), with at least one key and no repetition.
+     */
+    std::vector<std::string> parse_key_list(token_source<token_type>& ts);
+
+    void parse_global_definition(token_source<token_type>& ts);
+
+    // FIRST(key_value) = {key, override_keyword}
+    key_value_definition parse_key_value_definition(token_source<token_type>& ts);
+
+    multi_value parse_value_list(token_source<token_type>& ts);
+
+    basic_value* parse_value(token_source<token_type>& ts);
+
+    // FIRST(integer_value) = {integer}
+    basic_value* parse_integer_value(token_source<token_type>& ts);
+
+    // FIRST(integer_value) = {real}
+    basic_value* parse_real_value(token_source<token_type>& ts);
+
+    // FIRST(integer_value) = {string}
+    basic_value* parse_string_value(token_source<token_type>& ts);
+
+    // FIRST(enum_token) = {enum_token}
+    basic_value* parse_enum_item(token_source<token_type>& ts);
+
+    // FIRST(integer_value) = {boolean}
+    basic_value* parse_boolean_value(token_source<token_type>& ts);
+
+    basic_value* parse_key_value(token_source<token_type>& ts);
+
+    void parse_import_statment(token_source<token_type>& ts);
+
+    /*
+     * FIRST(table import) = {enum_token}, after the import keyword:
+     *
+     *   import #csv "curve.csv" -> curve
+     *   import #binary "profile.bin" -> profile [ x: #real  id: #integer ]
+     *   import #csv "design.csv" -> (solver-id, tolerance)
+     *
+     * Each column of the table is defined as the key prefix-column. With
+     * a list of keys instead of a prefix, the rows of the table are the
+     * points of a point table, each key taking the column of its name.
+     */
+    void parse_table_import(token_source<token_type>& ts, token_type* import_token);
+
+    bool is_column_declaration_list(token_source<token_type>& ts);
+
+    table_column_declaration parse_column_declaration(token_source<token_type>& ts);
+
+  private:
+    collection& c;
+  };
+
+}
+
+#endif /* PARAMETER_PARSER_H */
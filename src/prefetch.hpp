@@ -0,0 +1,202 @@
+#ifndef PARAMETER_PREFETCH_H
+#define PARAMETER_PREFETCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * Sweep whose points are selected and resolved on a background
+   * thread while the caller works on the previous ones:
+   *
+   *   prefetching_sweep sweep(c);
+   *   while (sweep.next())
+   *     run(sweep.get_value<int>("space-subdivisions"),
+   *         sweep.get_value<double>("time-step"));
+   *
+   * The thread sweeps its own copy of the collection, taken by the
+   * constructor, and resolves the keys of each point: references are
+   * followed and strings interpolated. Up to window points are handed
+   * over in advance through a single producer, single consumer ring,
+   * so that the values of a point are ready when next returns. An error
+   * resolving a point is thrown by the next call reaching it.
+   */
+  class prefetching_sweep {
+  public:
+    prefetching_sweep(const collection& c, std::size_t window = 1)
+      : prefetching_sweep(c, c.get_keys(), window) {}
+
+    prefetching_sweep(const collection& c, const std::vector<std::string>& keys, std::size_t window = 1)
+      : local(c), keys(keys), slots(std::max<std::size_t>(window, 1) + 1),
+        point_number(c.get_collection_size()), head(0), tail(0),
+        current(nullptr), is_stopped(false) {
+      for (std::size_t i(0); i < keys.size(); ++i)
+        key_ids[keys[i]] = i;
+      producer = std::thread(&prefetching_sweep::produce, this);
+    }
+
+    ~prefetching_sweep() {
+      is_stopped.store(true);
+      notify();
+      producer.join();
+    }
+
+    prefetching_sweep(const prefetching_sweep&) = delete;
+    prefetching_sweep& operator=(const prefetching_sweep&) = delete;
+
+    /*
+     * Wait for the next point, false when the sweep is done.
+     */
+    bool next() {
+      if (current) {
+        // the slot is given back to the producer
+        current->clear();
+        current = nullptr;
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        notify();
+      }
+
+      const std::size_t t(tail.load(std::memory_order_relaxed));
+      if (t == point_number)
+        return false;
+
+      if (head.load(std::memory_order_acquire) == t) {
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait(lock, [this, t]() { return head.load(std::memory_order_acquire) != t; });
+      }
+
+      current = &slots[t % slots.size()];
+      if (current->error)
+        std::rethrow_exception(current->error);
+      return true;
+    }
+
+    /*
+     * Collection index of the current point.
+     */
+    std::size_t get_index() const {
+      return tail.load(std::memory_order_relaxed);
+    }
+
+    std::size_t get_point_number() const { return point_number; }
+
+    template<typename value_type>
+    value_type get_value(const std::string& key) const {
+      const basic_value* v(get_basic_value(key));
+      const value<value_type>* typed_v(dynamic_cast<const value<value_type>*>(v));
+      if (not typed_v)
+        throw std::string("failed to get a "
+                          + std::string(basic_value::type_names[value_type_index<value_type>::value])
+                          + " from the key '" + key + "' which has type " + v->get_type());
+      return typed_v->get_value();
+    }
+
+    std::string get_enum_token(const std::string& key) const {
+      const basic_value* v(get_basic_value(key));
+      const enum_value* e(dynamic_cast<const enum_value*>(v));
+      if (not e)
+        throw std::string("failed to get an enum value from the key '" + key
+                          + "' which has type " + v->get_type());
+      return e->get_token_value();
+    }
+
+    /*
+     * Resolved value of the key at the current point, owned by the
+     * sweep until the next call to next.
+     */
+    const basic_value* get_basic_value(const std::string& key) const {
+      if (not current)
+        throw std::string("no current point in the prefetching sweep");
+
+      const auto id(key_ids.find(key));
+      if (id == key_ids.end())
+        throw std::string("the key '" + key + "' is not resolved by the prefetching sweep");
+      return current->values[id->second];
+    }
+
+  private:
+    struct point {
+      std::vector<const basic_value*> values;
+      std::exception_ptr error;
+
+      ~point() { clear(); }
+
+      void clear() {
+        for (auto v: values)
+          delete v;
+        values.clear();
+        error = nullptr;
+      }
+    };
+
+    collection local;
+    const std::vector<std::string> keys;
+    std::map<std::string, std::size_t> key_ids;
+
+    // points [tail, head) are resolved and waiting in the ring, head
+    // is written by the producer only and tail by the consumer only
+    std::vector<point> slots;
+    const std::size_t point_number;
+    std::atomic<std::size_t> head;
+    std::atomic<std::size_t> tail;
+    point* current;
+
+    // only used to sleep when the ring is empty or full
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<bool> is_stopped;
+
+    std::thread producer;
+
+  private:
+    void produce() {
+      for (std::size_t i(0); i < point_number; ++i) {
+        if (i - tail.load(std::memory_order_acquire) == slots.size()) {
+          std::unique_lock<std::mutex> lock(m);
+          cv.wait(lock, [this, i]() {
+              return is_stopped.load() or i - tail.load(std::memory_order_acquire) < slots.size();
+            });
+        }
+
+        if (is_stopped.load())
+          return;
+
+        resolve(i, slots[i % slots.size()]);
+        head.store(i + 1, std::memory_order_release);
+        notify();
+      }
+    }
+
+    void resolve(std::size_t i, point& p) {
+      try {
+        local.set_current_collection(i);
+        p.values.reserve(keys.size());
+        for (const auto& key: keys)
+          p.values.push_back(local.get_resolved_value(key));
+      }
+      catch (...) {
+        p.error = std::current_exception();
+      }
+    }
+
+    void notify() {
+      // taking the lock orders the index update with the check of a
+      // thread about to wait
+      { std::lock_guard<std::mutex> lock(m); }
+      cv.notify_all();
+    }
+  };
+
+}
+
+#endif /* PARAMETER_PREFETCH_H */
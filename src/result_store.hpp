@@ -0,0 +1,124 @@
+#ifndef PARAMETER_RESULT_STORE_H
+#define PARAMETER_RESULT_STORE_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fingerprint.hpp"
+
+namespace parameter {
+
+  /*
+   * Results of the points of sweeps, stored in a directory under the
+   * fingerprint of the point, so that a point already computed by an
+   * earlier sweep, or by another configuration file giving the same
+   * values, is not computed again:
+   *
+   *   result_store store("results");
+   *   point_fingerprinter fp(c);
+   *   ...
+   *   const fingerprint f(fp.get());
+   *   std::string result;
+   *   if (not store.load(f, result)) {
+   *     result = run(c);
+   *     store.store(f, result);
+   *   }
+   *
+   * A result is the file dir/xx/yyy..., xx being the first two hex
+   * digits of the fingerprint. It is written to a temporary file of a
+   * unique name, synced and renamed, so that concurrent writers, even
+   * threads of the same process, a concurrent reader, or a crash,
+   * never leave a partial result behind.
+   */
+  class result_store {
+  public:
+    result_store(const std::string& directory)
+      : directory(directory) {
+      make_directory(directory);
+    }
+
+    const std::string& get_directory() const { return directory; }
+
+    std::string get_path(const fingerprint& f) const {
+      const std::string hex(f.to_string());
+      return directory + "/" + hex.substr(0, 2) + "/" + hex.substr(2);
+    }
+
+    bool contains(const fingerprint& f) const {
+      struct stat s;
+      return stat(get_path(f).c_str(), &s) == 0;
+    }
+
+    /*
+     * Returns false if no result is stored for the fingerprint.
+     */
+    bool load(const fingerprint& f, std::string& result) const {
+      std::ifstream file(get_path(f), std::ios::binary);
+      if (not file)
+        return false;
+
+      std::ostringstream content;
+      content << file.rdbuf();
+      result = content.str();
+      return true;
+    }
+
+    void store(const fingerprint& f, const std::string& result) const {
+      const std::string path(get_path(f));
+      make_directory(path.substr(0, path.rfind('/')));
+
+      std::string temporary(path + ".XXXXXX");
+      const int fd(mkstemp(&temporary[0]));
+      if (fd == -1)
+        throw std::string("failed to create a temporary file for the result file '" + path + "': ")
+          + std::strerror(errno);
+
+      std::size_t written(0);
+      while (written < result.size()) {
+        const ssize_t n(write(fd, result.data() + written, result.size() - written));
+        if (n == -1 and errno == EINTR)
+          continue;
+        if (n == -1)
+          break;
+        written += n;
+      }
+      if (written < result.size() or fchmod(fd, 0644) != 0 or fsync(fd) != 0) {
+        const std::string error(std::strerror(errno));
+        close(fd);
+        std::remove(temporary.c_str());
+        throw std::string("failed to write the result file '" + temporary + "': ") + error;
+      }
+      close(fd);
+
+      if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        const std::string error(std::strerror(errno));
+        std::remove(temporary.c_str());
+        throw std::string("failed to store the result file '" + path + "': ") + error;
+      }
+    }
+
+    void remove(const fingerprint& f) const {
+      std::remove(get_path(f).c_str());
+    }
+
+  private:
+    std::string directory;
+
+  private:
+    static void make_directory(const std::string& path) {
+      if (mkdir(path.c_str(), 0755) != 0 and errno != EEXIST)
+        throw std::string("failed to create the result directory '" + path + "': ") + std::strerror(errno);
+    }
+  };
+
+}
+
+#endif /* PARAMETER_RESULT_STORE_H */
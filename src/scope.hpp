@@ -0,0 +1,83 @@
+#ifndef PARAMETER_SCOPE_H
+#define PARAMETER_SCOPE_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * Access to the keys of a namespace by their name relative to it:
+   *
+   *   collection_scope solver(c, "solver");
+   *   solver.get_value<double>("linear.tol");  // key solver.linear.tol
+   *
+   * The scope only holds a reference to the collection and the prefix
+   * of the namespace, the values are read from the current point of
+   * the collection.
+   */
+  class collection_scope {
+  public:
+    collection_scope(const collection& c, const std::string& name)
+      : c(c), prefix(name.empty() ? name : name + ".") {}
+
+    collection_scope get_scope(const std::string& name) const {
+      return collection_scope(c, prefix + name);
+    }
+
+    const std::string& get_prefix() const { return prefix; }
+    std::string get_key(const std::string& key) const { return prefix + key; }
+
+    template<typename value_type>
+    value_type get_value(const std::string& key) const {
+      return c.get_value<value_type>(prefix + key);
+    }
+
+    template<typename value_type>
+    bool try_get_value(const std::string& key, value_type& result) const {
+      return c.try_get_value(prefix + key, result);
+    }
+
+    template<typename value_type>
+    value_type get_value_or(const std::string& key, const value_type& default_value) const {
+      return c.get_value_or(prefix + key, default_value);
+    }
+
+    std::string get_value_or(const std::string& key, const char* default_value) const {
+      return c.get_value_or(prefix + key, default_value);
+    }
+
+    template<typename enum_type>
+    enum_type get_enum_value(const std::string& key,
+                             const std::map<std::string, enum_type>& token_map) const {
+      return c.get_enum_value(prefix + key, token_map);
+    }
+
+    const basic_value* get_basic_value(const std::string& key) const {
+      return c.get_basic_value(prefix + key);
+    }
+
+    bool contains(const std::string& key) const { return c.contains(prefix + key); }
+
+    /*
+     * Keys of the namespace and of its nested namespaces, relative to
+     * the scope.
+     */
+    std::vector<std::string> get_keys() const {
+      std::vector<std::string> keys(c.get_keys_with_prefix(prefix));
+      for (auto& key: keys)
+        key.erase(0, prefix.size());
+      return keys;
+    }
+
+  private:
+    const collection& c;
+    const std::string prefix;
+  };
+
+}
+
+#endif /* PARAMETER_SCOPE_H */
@@ -0,0 +1,311 @@
+#ifndef PARAMETER_SHARED_H
+#define PARAMETER_SHARED_H
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace parameter {
+
+  /*
+   * Layout of a collection published in a POSIX shared memory segment.
+   * Every reference is an offset from the beginning of the segment, so
+   * that each process can map it at any address:
+   *
+   *   header
+   *   dimensions: uint64 size, uint64 key number and float64 cost each
+   *   keys:       sorted by name
+   *   values:     the values of the keys, key after key
+   *   strings:    key names, string values and enum items
+   *
+   * The header also records the process which creates the segment, so
+   * that the other ones stop waiting if it dies before publishing, and
+   * the file the collection was read from with its size and time of
+   * modification when read_shared publishes it.
+   */
+  struct shared_header {
+    char magic[8];
+    std::uint32_t state;
+    std::int32_t creator;
+    std::uint64_t size;
+    std::uint64_t dimension_number;
+    std::uint64_t dimension_offset;
+    std::uint64_t key_number;
+    std::uint64_t key_offset;
+    std::uint64_t value_number;
+    std::uint64_t value_offset;
+    std::uint64_t source_name_offset;
+    std::uint64_t source_name_size;
+    std::uint64_t source_file_size;
+    std::int64_t source_modification_time;
+
+    enum : std::uint32_t { loading = 0, ready = 1, failed = 2 };
+  };
+
+  struct shared_dimension {
+    std::uint64_t size;
+    std::uint64_t key_number;
+    double cost;
+  };
+
+  struct shared_key {
+    std::uint64_t name_offset;
+    std::uint64_t name_size;
+    std::uint64_t index_id;
+    std::uint64_t first_value;
+    std::uint64_t value_number;
+  };
+
+  struct shared_value {
+    enum : std::uint32_t { integer, real, boolean, string, enum_item, reference };
+
+    std::uint32_t type;
+    std::uint32_t reserved;
+    union {
+      std::int64_t integer_value;
+      double real_value;
+      struct {
+        std::uint64_t offset;
+        std::uint64_t size;
+      } text;
+    };
+  };
+
+  /*
+   * Mapping of a shared memory segment, writable for its creator and
+   * read-only for the processes attaching to it.
+   */
+  class shared_segment {
+  public:
+    ~shared_segment() {
+      if (address)
+        munmap(address, length);
+      if (fd != -1)
+        close(fd);
+    }
+
+    shared_segment(const shared_segment&) = delete;
+    shared_segment& operator=(const shared_segment&) = delete;
+
+    /*
+     * Returns nullptr when the segment already exists.
+     */
+    static std::unique_ptr<shared_segment> create(const std::string& name) {
+      const int fd(shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644));
+      if (fd == -1 and errno == EEXIST)
+        return nullptr;
+      if (fd == -1)
+        throw std::string("failed to create the shared memory segment '" + name + "': ") + std::strerror(errno);
+
+      std::unique_ptr<shared_segment> s(new shared_segment(name, fd));
+      s->resize(sizeof(shared_header));
+      __atomic_store_n(&s->get_header()->creator, std::int32_t(getpid()), __ATOMIC_RELEASE);
+      return s;
+    }
+
+    /*
+     * Wait for the creator to publish the segment, and map it read-only.
+     * The wait ends with an error when the creator process is gone
+     * without publishing it.
+     */
+    static std::unique_ptr<shared_segment> attach(const std::string& name) {
+      const int fd(shm_open(name.c_str(), O_RDONLY, 0));
+      if (fd == -1)
+        throw std::string("failed to open the shared memory segment '" + name + "': ") + std::strerror(errno);
+      std::unique_ptr<shared_segment> s(new shared_segment(name, fd));
+
+      while (true) {
+        struct stat st;
+        fstat(fd, &st);
+        if (static_cast<std::size_t>(st.st_size) >= sizeof(shared_header)) {
+          s->map(st.st_size, PROT_READ);
+          const std::uint32_t state(__atomic_load_n(&s->get_header()->state, __ATOMIC_ACQUIRE));
+          if (state == shared_header::failed)
+            throw std::string("the collection of the shared memory segment '" + name + "' failed to load");
+          if (state == shared_header::ready) {
+            if (std::memcmp(s->get_header()->magic, magic(), 8) != 0)
+              throw std::string("the shared memory segment '" + name + "' does not hold a collection");
+            if (s->get_header()->size != s->length)
+              s->map(s->get_header()->size, PROT_READ);
+            return s;
+          }
+
+          const std::int32_t creator(__atomic_load_n(&s->get_header()->creator, __ATOMIC_ACQUIRE));
+          if (creator != 0 and kill(creator, 0) == -1 and errno == ESRCH
+              and __atomic_load_n(&s->get_header()->state, __ATOMIC_ACQUIRE) == shared_header::loading)
+            throw std::string("the process creating the shared memory segment '" + name
+                              + "' exited before publishing the collection, unlink the segment to read the file again");
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+
+    static void unlink(const std::string& name) { shm_unlink(name.c_str()); }
+
+    static const char* magic() { return "PRMSHM02"; }
+
+    /*
+     * Size and time of modification, in nanoseconds, of the file a
+     * collection is read from.
+     */
+    static void get_file_identity(const std::string& filename,
+                                  std::uint64_t& file_size, std::int64_t& modification_time) {
+      struct stat st;
+      if (stat(filename.c_str(), &st) != 0)
+        throw std::string("failed to stat the file '" + filename + "': ") + std::strerror(errno);
+      file_size = st.st_size;
+      modification_time = std::int64_t(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    }
+
+    /*
+     * Copy the image, whose state is set last so that attaching
+     * processes never see a partial collection.
+     */
+    void publish(const std::string& image) {
+      const std::size_t tables(offsetof(shared_header, size));
+      resize(image.size());
+      std::memcpy(static_cast<char*>(address) + tables, image.data() + tables, image.size() - tables);
+      std::memcpy(address, image.data(), sizeof(shared_header::magic));
+      __atomic_store_n(&get_header()->state, std::uint32_t(shared_header::ready), __ATOMIC_RELEASE);
+    }
+
+    void fail() {
+      __atomic_store_n(&get_header()->state, std::uint32_t(shared_header::failed), __ATOMIC_RELEASE);
+    }
+
+    const shared_header* get_header() const { return static_cast<const shared_header*>(address); }
+    shared_header* get_header() { return static_cast<shared_header*>(address); }
+
+    const char* data() const { return static_cast<const char*>(address); }
+    std::size_t size() const { return length; }
+
+  private:
+    std::string name;
+    int fd;
+    void* address;
+    std::size_t length;
+
+  private:
+    shared_segment(const std::string& name, int fd)
+      : name(name), fd(fd), address(nullptr), length(0) {}
+
+    void map(std::size_t size, int protection) {
+      if (address)
+        munmap(address, length);
+      address = mmap(nullptr, size, protection, MAP_SHARED, fd, 0);
+      if (address == MAP_FAILED) {
+        address = nullptr;
+        throw std::string("failed to map the shared memory segment '" + name + "': ") + std::strerror(errno);
+      }
+      length = size;
+    }
+
+    void resize(std::size_t size) {
+      if (ftruncate(fd, size) != 0)
+        throw std::string("failed to resize the shared memory segment '" + name + "': ") + std::strerror(errno);
+      map(size, PROT_READ | PROT_WRITE);
+    }
+  };
+
+  /*
+   * Read access to the tables of a published collection.
+   */
+  class shared_image {
+  public:
+    shared_image(std::unique_ptr<shared_segment>&& s): segment(std::move(s)) {}
+
+    const shared_header& get_header() const { return *segment->get_header(); }
+
+    const shared_dimension& get_dimension(std::size_t i) const {
+      return at<shared_dimension>(get_header().dimension_offset)[i];
+    }
+
+    const shared_key& get_key(std::size_t i) const {
+      return at<shared_key>(get_header().key_offset)[i];
+    }
+
+    const shared_value& get_value(std::size_t i) const {
+      return at<shared_value>(get_header().value_offset)[i];
+    }
+
+    std::string get_key_name(const shared_key& k) const {
+      return std::string(segment->data() + k.name_offset, k.name_size);
+    }
+
+    std::string get_text(const shared_value& v) const {
+      return std::string(segment->data() + v.text.offset, v.text.size);
+    }
+
+    /*
+     * Whether the collection was published by read_shared from this
+     * file, in its current state.
+     */
+    bool is_read_from(const std::string& filename) const {
+      const shared_header& h(get_header());
+      std::uint64_t file_size(0);
+      std::int64_t modification_time(0);
+      shared_segment::get_file_identity(filename, file_size, modification_time);
+      return h.source_name_size == filename.size()
+        and std::memcmp(segment->data() + h.source_name_offset, filename.data(), filename.size()) == 0
+        and h.source_file_size == file_size
+        and h.source_modification_time == modification_time;
+    }
+
+    /*
+     * Binary search in the sorted key table, nullptr when not found.
+     */
+    const shared_key* find(const std::string& key) const {
+      const std::size_t i(lower_bound(key));
+      return i < get_header().key_number and compare(get_key(i), key) == 0 ? &get_key(i) : nullptr;
+    }
+
+    /*
+     * Index of the first key not smaller than the given one.
+     */
+    std::size_t lower_bound(const std::string& key) const {
+      const shared_key* begin(&get_key(0));
+      const shared_key* end(begin + get_header().key_number);
+      return std::lower_bound(begin, end, key,
+                              [this](const shared_key& k, const std::string& key) {
+                                return compare(k, key) < 0;
+                              }) - begin;
+    }
+
+    bool has_prefix(const shared_key& k, const std::string& prefix) const {
+      return k.name_size >= prefix.size()
+        and std::memcmp(segment->data() + k.name_offset, prefix.data(), prefix.size()) == 0;
+    }
+
+  private:
+    std::unique_ptr<shared_segment> segment;
+
+  private:
+    template<typename T>
+    const T* at(std::uint64_t offset) const {
+      return reinterpret_cast<const T*>(segment->data() + offset);
+    }
+
+    int compare(const shared_key& k, const std::string& key) const {
+      const int c(std::memcmp(segment->data() + k.name_offset, key.data(),
+                              std::min<std::size_t>(k.name_size, key.size())));
+      if (c)
+        return c;
+      return k.name_size < key.size() ? -1 : (k.name_size > key.size() ? 1 : 0);
+    }
+  };
+
+}
+
+#endif /* PARAMETER_SHARED_H */
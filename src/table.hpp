@@ -0,0 +1,373 @@
+#ifndef PARAMETER_TABLE_H
+#define PARAMETER_TABLE_H
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace parameter {
+
+  /*
+   * Read-only mapping of a whole file. Empty files are not mapped.
+   */
+  class mapped_file {
+  public:
+    mapped_file(const std::string& path): address(nullptr), length(0) {
+      const int fd(open(path.c_str(), O_RDONLY));
+      if (fd == -1)
+        throw std::string("file '" + path + "' is not accessible");
+
+      struct stat s;
+      if (fstat(fd, &s) != 0) {
+        close(fd);
+        throw std::string("failed to stat file '" + path + "'");
+      }
+
+      length = s.st_size;
+      if (length) {
+        address = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        if (address == MAP_FAILED) {
+          close(fd);
+          throw std::string("failed to map file '" + path + "': ") + std::strerror(errno);
+        }
+      }
+      close(fd);
+    }
+
+    ~mapped_file() {
+      if (address)
+        munmap(address, length);
+    }
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    const char* data() const { return static_cast<const char*>(address); }
+    std::size_t size() const { return length; }
+
+  private:
+    void* address;
+    std::size_t length;
+  };
+
+  /*
+   * A typed column of an imported table. The storage is either the
+   * mapped file itself (binary tables) or a vector filled by the CSV
+   * reader, and is kept alive by owner.
+   */
+  struct table_column {
+    enum class type { integer, real };
+
+    std::string name;
+    type t;
+    std::shared_ptr<const void> owner;
+    const void* data;
+    std::size_t size;
+  };
+
+  struct table_column_declaration {
+    std::string name;
+    table_column::type t;
+  };
+
+  /*
+   * Binary tables are raw little endian columns stored one after the
+   * other: integer columns are int32, real columns are float64, and all
+   * the columns have the same number of rows. The columns point
+   * directly into the mapping.
+   */
+  inline
+  std::vector<table_column> map_binary_table(const std::string& path,
+                                             const std::vector<table_column_declaration>& declarations) {
+    const std::uint16_t one(1);
+    if (*reinterpret_cast<const unsigned char*>(&one) != 1)
+      throw std::string("binary tables are only supported on little endian hosts");
+
+    if (declarations.empty())
+      throw std::string("the binary table '" + path + "' needs a column declaration");
+
+    std::shared_ptr<const mapped_file> file(std::make_shared<mapped_file>(path));
+
+    std::size_t row_size(0);
+    for (const auto& d: declarations)
+      row_size += d.t == table_column::type::integer ? sizeof(std::int32_t) : sizeof(double);
+
+    if (file->size() % row_size)
+      throw std::string("the size of the binary table '" + path
+                        + "' is not a multiple of the declared row size");
+
+    const std::size_t row_number(file->size() / row_size);
+    std::vector<table_column> columns;
+    std::size_t offset(0);
+    for (const auto& d: declarations) {
+      const std::size_t element_size(d.t == table_column::type::integer ? sizeof(std::int32_t) : sizeof(double));
+      if (offset % element_size)
+        throw std::string("the column '" + d.name + "' of the binary table '" + path
+                          + "' is not aligned, declare the real columns first");
+
+      table_column c;
+      c.name = d.name;
+      c.t = d.t;
+      c.owner = file;
+      c.data = file->data() + offset;
+      c.size = row_number;
+      columns.push_back(c);
+
+      offset += element_size * row_number;
+    }
+
+    return columns;
+  }
+
+  namespace detail {
+
+    struct csv_chunk {
+      const char* begin;
+      const char* end;
+      std::vector<std::vector<double> > values;
+      std::vector<bool> is_integer;
+      std::size_t line_number;
+      std::size_t error_line;
+      std::string error;
+    };
+
+    inline
+    std::string trim_csv_field(const char* begin, const char* end) {
+      while (begin < end and std::isspace(static_cast<unsigned char>(*begin)))
+        ++begin;
+      while (end > begin and std::isspace(static_cast<unsigned char>(*(end - 1))))
+        --end;
+      if (end - begin >= 2 and *begin == '"' and *(end - 1) == '"') {
+        ++begin;
+        --end;
+      }
+      return std::string(begin, end);
+    }
+
+    inline
+    bool parse_csv_number(const char* begin, const char* end, double& v, bool& is_integer) {
+      while (begin < end and std::isspace(static_cast<unsigned char>(*begin)))
+        ++begin;
+      while (end > begin and std::isspace(static_cast<unsigned char>(*(end - 1))))
+        --end;
+
+      char buffer[64];
+      const std::size_t n(end - begin);
+      if (n == 0 or n >= sizeof(buffer))
+        return false;
+      std::memcpy(buffer, begin, n);
+      buffer[n] = '\0';
+
+      char* parsed_end(nullptr);
+      v = std::strtod(buffer, &parsed_end);
+      if (parsed_end != buffer + n)
+        return false;
+
+      is_integer = true;
+      for (std::size_t i(0); i < n; ++i)
+        if (not (std::isdigit(static_cast<unsigned char>(buffer[i]))
+                 or (i == 0 and (buffer[i] == '+' or buffer[i] == '-'))))
+          is_integer = false;
+
+      // an integer out of the int32 range can only be a real
+      if (is_integer) {
+        errno = 0;
+        const long long i(std::strtoll(buffer, nullptr, 10));
+        if (errno == ERANGE
+            or i < std::numeric_limits<std::int32_t>::min()
+            or i > std::numeric_limits<std::int32_t>::max())
+          is_integer = false;
+      }
+
+      return true;
+    }
+
+    inline
+    void parse_csv_chunk(csv_chunk& chunk, std::size_t column_number) {
+      chunk.values.assign(column_number, std::vector<double>());
+      chunk.is_integer.assign(column_number, true);
+      chunk.line_number = 0;
+
+      const char* line(chunk.begin);
+      while (line < chunk.end) {
+        const char* line_end(static_cast<const char*>(std::memchr(line, '\n', chunk.end - line)));
+        if (not line_end)
+          line_end = chunk.end;
+        chunk.line_number += 1;
+
+        const char* p(line);
+        while (p < line_end and std::isspace(static_cast<unsigned char>(*p)))
+          ++p;
+
+        if (p < line_end) {
+          std::size_t column(0);
+          const char* field(line);
+          while (true) {
+            const char* field_end(static_cast<const char*>(std::memchr(field, ',', line_end - field)));
+            if (not field_end)
+              field_end = line_end;
+
+            double v(0.);
+            bool is_integer(false);
+            if (column >= column_number or not parse_csv_number(field, field_end, v, is_integer)) {
+              chunk.error_line = chunk.line_number;
+              chunk.error = column >= column_number ?
+                "too many fields" : "invalid number '" + trim_csv_field(field, field_end) + "'";
+              return;
+            }
+            chunk.values[column].push_back(v);
+            chunk.is_integer[column] = chunk.is_integer[column] and is_integer;
+            column += 1;
+
+            if (field_end == line_end)
+              break;
+            field = field_end + 1;
+          }
+
+          if (column != column_number) {
+            chunk.error_line = chunk.line_number;
+            chunk.error = "too few fields";
+            return;
+          }
+        }
+
+        line = line_end + 1;
+      }
+    }
+
+  }
+
+  /*
+   * CSV tables start with a header line naming the columns, followed by
+   * rows of numbers. The rows are parsed in parallel chunks split at
+   * line boundaries. Without declaration every column is imported, as
+   * an integer column when all its fields are integers in the int32
+   * range and as a real column otherwise.
+   */
+  inline
+  std::vector<table_column> read_csv_table(const std::string& path,
+                                           const std::vector<table_column_declaration>& declarations) {
+    const mapped_file file(path);
+    const char* begin(file.data());
+    const char* end(begin + file.size());
+
+    const char* header_end(begin ? static_cast<const char*>(std::memchr(begin, '\n', file.size())) : nullptr);
+    if (not header_end)
+      header_end = end;
+
+    std::vector<std::string> names;
+    for (const char* field(begin); field <= header_end and begin;) {
+      const char* field_end(static_cast<const char*>(std::memchr(field, ',', header_end - field)));
+      if (not field_end)
+        field_end = header_end;
+      names.push_back(detail::trim_csv_field(field, field_end));
+      field = field_end + 1;
+    }
+    if (names.empty())
+      throw std::string("the CSV table '" + path + "' has no header line");
+
+    // split the body in chunks of lines
+    const char* body(header_end < end ? header_end + 1 : end);
+    const std::size_t minimal_chunk_size(1 << 20);
+    const std::size_t chunk_number(std::max<std::size_t>(1, std::min<std::size_t>(
+      std::max(1u, std::thread::hardware_concurrency()),
+      (end - body) / minimal_chunk_size)));
+
+    std::vector<detail::csv_chunk> chunks(chunk_number);
+    const char* chunk_begin(body);
+    for (std::size_t i(0); i < chunk_number; ++i) {
+      const char* chunk_end(i + 1 == chunk_number ? end : body + (end - body) * (i + 1) / chunk_number);
+      if (chunk_end < chunk_begin)
+        chunk_end = chunk_begin;
+      while (chunk_end < end and *(chunk_end - 1) != '\n')
+        ++chunk_end;
+
+      chunks[i].begin = chunk_begin;
+      chunks[i].end = chunk_end;
+      chunk_begin = chunk_end;
+    }
+
+    std::vector<std::thread> threads;
+    for (std::size_t i(1); i < chunk_number; ++i)
+      threads.push_back(std::thread(detail::parse_csv_chunk, std::ref(chunks[i]), names.size()));
+    detail::parse_csv_chunk(chunks[0], names.size());
+    for (auto& t: threads)
+      t.join();
+
+    std::size_t line(1);
+    for (const auto& chunk: chunks) {
+      if (chunk.error.size())
+        throw std::string("failed to read the CSV table '") + path + "' at line "
+          + std::to_string(line + chunk.error_line) + ": " + chunk.error;
+      line += chunk.line_number;
+    }
+
+    std::vector<table_column_declaration> selection(declarations);
+    if (selection.empty())
+      for (std::size_t k(0); k < names.size(); ++k) {
+        bool is_integer(true);
+        for (const auto& chunk: chunks)
+          is_integer = is_integer and chunk.is_integer[k];
+        table_column_declaration d = { names[k], is_integer ? table_column::type::integer : table_column::type::real };
+        selection.push_back(d);
+      }
+
+    std::vector<table_column> columns;
+    for (const auto& d: selection) {
+      const auto name(std::find(names.begin(), names.end(), d.name));
+      if (name == names.end())
+        throw std::string("the CSV table '" + path + "' has no column named '" + d.name + "'");
+      const std::size_t k(name - names.begin());
+
+      std::size_t row_number(0);
+      for (const auto& chunk: chunks)
+        row_number += chunk.values[k].size();
+
+      table_column c;
+      c.name = d.name;
+      c.t = d.t;
+      c.size = row_number;
+
+      if (d.t == table_column::type::integer) {
+        std::shared_ptr<std::vector<int> > values(std::make_shared<std::vector<int> >());
+        values->reserve(row_number);
+        for (const auto& chunk: chunks) {
+          if (not chunk.is_integer[k])
+            throw std::string("the column '" + d.name + "' of the CSV table '" + path
+                              + "' is declared integer but contains real numbers or integers out of the int32 range");
+          values->insert(values->end(), chunk.values[k].begin(), chunk.values[k].end());
+        }
+        c.data = values->data();
+        c.owner = values;
+      } else {
+        std::shared_ptr<std::vector<double> > values(std::make_shared<std::vector<double> >());
+        values->reserve(row_number);
+        for (const auto& chunk: chunks)
+          values->insert(values->end(), chunk.values[k].begin(), chunk.values[k].end());
+        c.data = values->data();
+        c.owner = values;
+      }
+
+      columns.push_back(c);
+    }
+
+    return columns;
+  }
+
+}
+
+#endif /* PARAMETER_TABLE_H */
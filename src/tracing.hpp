@@ -0,0 +1,258 @@
+#ifndef PARAMETER_TRACING_H
+#define PARAMETER_TRACING_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <limits>
+#include <thread>
+
+#include "exporter.hpp"
+
+namespace parameter {
+
+  /*
+   * Record the execution time of each sweep point:
+   *
+   *   sweep_tracer tracer({"space-subdivisions", "time-subdivisions"});
+   *   for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+   *     sweep_tracer::scope s(tracer, i);
+   *     c.set_current_collection(i);
+   *     run(c);
+   *   }
+   *   tracer.write_chrome_trace(c, trace_file);
+   *   tracer.write_summary(c, std::cout);
+   *
+   * Each thread appends its events to its own buffer, so that recording
+   * a point only costs two clock reads and an append. The values of the
+   * traced keys are only resolved when the trace is written.
+   */
+  class sweep_tracer {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct event {
+      std::size_t index;
+      clock::time_point start;
+      clock::time_point end;
+    };
+
+    class scope {
+    public:
+      scope(sweep_tracer& t, std::size_t index)
+        : t(t), index(index), start(clock::now()) {}
+
+      ~scope() { t.record(index, start, clock::now()); }
+
+      scope(const scope&) = delete;
+      scope& operator=(const scope&) = delete;
+
+    private:
+      sweep_tracer& t;
+      const std::size_t index;
+      const clock::time_point start;
+    };
+
+    static constexpr std::size_t max_thread_number = 1024;
+
+    sweep_tracer(const std::vector<std::string>& keys = std::vector<std::string>())
+      : keys(keys), id(next_id()), origin(clock::now()), buffer_number(0) {
+      for (auto& b: buffers)
+        b.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~sweep_tracer() {
+      for (auto& b: buffers)
+        delete b.load();
+    }
+
+    sweep_tracer(const sweep_tracer&) = delete;
+    sweep_tracer& operator=(const sweep_tracer&) = delete;
+
+    void record(std::size_t index, clock::time_point start, clock::time_point end) {
+      event e = { index, start, end };
+      get_thread_buffer().events.push_back(e);
+    }
+
+    /*
+     * The recording threads must be done when the events are read.
+     */
+    std::size_t get_event_number() const {
+      std::size_t n(0);
+      for (std::size_t i(0); i < get_thread_number(); ++i)
+        n += buffers[i].load()->events.size();
+      return n;
+    }
+
+    std::size_t get_thread_number() const {
+      // a slot is counted before its buffer is published
+      std::size_t n(0);
+      while (n < buffer_number.load() and buffers[n].load())
+        n += 1;
+      return n;
+    }
+
+    /*
+     * Chrome trace event format, as read by chrome://tracing and
+     * Perfetto: one complete event per point, with the values of the
+     * traced keys as arguments.
+     */
+    void write_chrome_trace(const collection& c, std::ostream& stream) const {
+      collection local(c);
+      std::string out("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+      bool first(true);
+      for (std::size_t t(0); t < get_thread_number(); ++t)
+        for (const auto& e: buffers[t].load()->events) {
+          out += first ? "\n" : ",\n";
+          first = false;
+
+          out += "{\"name\":\"point ";
+          append_integer(out, e.index);
+          out += "\",\"ph\":\"X\",\"pid\":0,\"tid\":";
+          append_integer(out, t);
+          out += ",\"ts\":";
+          append_real(out, to_microseconds(e.start - origin));
+          out += ",\"dur\":";
+          append_real(out, to_microseconds(e.end - e.start));
+          out += ",\"args\":{\"index\":";
+          append_integer(out, e.index);
+
+          local.set_current_collection(e.index);
+          for (const auto& key: keys) {
+            out += ",";
+            append_json_string(out, key);
+            out += ":";
+            const basic_value* v(local.get_basic_value(key)->eval(local));
+            append_json_value(out, v);
+            delete v;
+          }
+          out += "}}";
+
+          if (out.size() > (1 << 16)) {
+            stream << out;
+            out.clear();
+          }
+        }
+
+      out += "\n]}\n";
+      stream << out;
+    }
+
+    /*
+     * For each varying dimension, the mean time of the points taking
+     * each of its values, and its ratio to the cheapest value of the
+     * dimension.
+     */
+    void write_summary(const collection& c, std::ostream& stream) const {
+      collection local(c);
+
+      for (const auto& dimension_keys: local.get_iteration_order()) {
+        const std::size_t size(local.get_projection_size(dimension_keys));
+        std::vector<double> total(size, 0.);
+        std::vector<std::size_t> count(size, 0);
+        std::vector<std::size_t> sample(size, 0);
+
+        for (std::size_t t(0); t < get_thread_number(); ++t)
+          for (const auto& e: buffers[t].load()->events) {
+            local.set_current_collection(e.index);
+            const std::size_t i(local.projection_index(dimension_keys));
+            total[i] += to_microseconds(e.end - e.start);
+            count[i] += 1;
+            sample[i] = e.index;
+          }
+
+        double cheapest(std::numeric_limits<double>::max());
+        for (std::size_t i(0); i < size; ++i)
+          if (count[i])
+            cheapest = std::min(cheapest, total[i] / count[i]);
+
+        stream << "dimension";
+        for (const auto& key: dimension_keys)
+          stream << " " << key;
+        stream << ":" << std::endl;
+
+        for (std::size_t i(0); i < size; ++i) {
+          if (count[i] == 0)
+            continue;
+
+          local.set_current_collection(sample[i]);
+          std::string values;
+          for (const auto& key: dimension_keys) {
+            const basic_value* v(local.get_basic_value(key)->eval(local));
+            values += (values.size() ? ", " : "") + key + "=" + v->print_value();
+            delete v;
+          }
+
+          const double mean(total[i] / count[i]);
+          stream << "  " << std::setw(40) << std::left << values << std::right
+                 << std::setw(8) << count[i] << " points, mean "
+                 << std::setw(12) << mean << " us, "
+                 << std::setprecision(3) << (cheapest > 0. ? mean / cheapest : 1.) << "x"
+                 << std::setprecision(6) << std::endl;
+        }
+      }
+    }
+
+  private:
+    struct thread_buffer {
+      const std::thread::id owner;
+      std::vector<event> events;
+
+      thread_buffer(): owner(std::this_thread::get_id()) { events.reserve(4096); }
+    };
+
+    struct thread_cache {
+      std::uint64_t tracer_id;
+      thread_buffer* buffer;
+    };
+
+    const std::vector<std::string> keys;
+    const std::uint64_t id;
+    const clock::time_point origin;
+
+    std::atomic<std::size_t> buffer_number;
+    std::atomic<thread_buffer*> buffers[max_thread_number];
+
+  private:
+    static std::uint64_t next_id() {
+      static std::atomic<std::uint64_t> id(0);
+      return ++id;
+    }
+
+    /*
+     * The last buffer used by the thread is cached, a new one is only
+     * allocated the first time a thread records into a tracer.
+     */
+    thread_buffer& get_thread_buffer() {
+      static thread_local thread_cache cache = { 0, nullptr };
+      if (cache.tracer_id == id)
+        return *cache.buffer;
+
+      for (std::size_t i(0); i < get_thread_number(); ++i)
+        if (buffers[i].load()->owner == std::this_thread::get_id()) {
+          cache.tracer_id = id;
+          cache.buffer = buffers[i].load();
+          return *cache.buffer;
+        }
+
+      const std::size_t slot(buffer_number.fetch_add(1));
+      if (slot >= max_thread_number)
+        throw string_builder("sweep_tracer supports at most ")(std::size_t(max_thread_number))(" threads").str();
+
+      thread_buffer* b(new thread_buffer);
+      buffers[slot].store(b);
+      cache.tracer_id = id;
+      cache.buffer = b;
+      return *b;
+    }
+
+    static double to_microseconds(clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count();
+    }
+  };
+
+}
+
+#endif /* PARAMETER_TRACING_H */
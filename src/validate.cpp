@@ -0,0 +1,67 @@
+#include "validation.hpp"
+
+void print_usage(const char* program) {
+  std::cout << "usage: " << program << " [-s schema] [-j threads] file... " << std::endl
+            << "  the file names are read from the standard input when the only file is '-'" << std::endl;
+}
+
+int main(int argc, char** argv) {
+  try {
+    parameter::schema s;
+    parameter::validator v;
+    std::vector<std::string> filenames;
+
+    for (int i(1); i < argc; ++i) {
+      const std::string arg(argv[i]);
+      if (arg == "-s" and i + 1 < argc) {
+        s.read_from_file(argv[++i]);
+        v.set_schema(&s);
+      } else if (arg == "-j" and i + 1 < argc) {
+        v.set_thread_number(std::stoul(argv[++i]));
+      } else if (arg == "-h" or arg == "--help") {
+        print_usage(argv[0]);
+        return 0;
+      } else {
+        filenames.push_back(arg);
+      }
+    }
+
+    if (filenames.size() == 1 and filenames.front() == "-") {
+      filenames.clear();
+      std::string filename;
+      while (std::getline(std::cin, filename))
+        if (filename.size())
+          filenames.push_back(filename);
+    }
+
+    if (filenames.empty()) {
+      print_usage(argv[0]);
+      return 1;
+    }
+
+    const std::vector<parameter::file_report> reports(v.validate(filenames));
+
+    std::size_t error_number(0), warning_number(0), failed_file_number(0);
+    for (const auto& r: reports) {
+      for (const auto& d: r.diagnostics)
+        std::cout << r.filename << ": " << d << '\n';
+
+      error_number += r.get_error_number();
+      warning_number += r.get_warning_number();
+      if (r.get_error_number())
+        failed_file_number += 1;
+    }
+
+    std::cout << reports.size() << " file(s) validated, "
+              << failed_file_number << " with errors, "
+              << error_number << " error(s), "
+              << warning_number << " warning(s)" << std::endl;
+
+    return failed_file_number ? 1 : 0;
+  }
+  catch (const std::string& e) {
+    std::cout << e << std::endl;
+  }
+
+  return 1;
+}
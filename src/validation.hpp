@@ -0,0 +1,218 @@
+#ifndef PARAMETER_VALIDATION_H
+#define PARAMETER_VALIDATION_H
+
+#include <algorithm>
+#include <atomic>
+#include <set>
+#include <thread>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * A schema is itself a parameter file. Each key maps to a list of
+   * enum items, the first one naming the expected type:
+   *
+   *   space-subdivisions = #integer
+   *   output-prefix = #string
+   *   verbose = #boolean, #optional
+   *   left-bc-type = #enum, #neumann, #dirichlet, #robin
+   *
+   * Keys flagged #optional may be absent from a validated file, the
+   * remaining items of an #enum entry form the accepted value set.
+   */
+  class schema {
+  public:
+    struct entry {
+      std::string type;
+      bool is_optional;
+      std::set<std::string> enum_items;
+
+      entry(): is_optional(false) {}
+    };
+
+    void read_from_file(const std::string& filename) {
+      collection c;
+      c.read_from_file(filename);
+
+      for (const auto& key: c.get_keys()) {
+        const collection::multi_value& mv(c.get_multi_value(key));
+
+        entry e;
+        for (std::size_t i(0); i < mv.values.size(); ++i) {
+          const enum_value* item(dynamic_cast<const enum_value*>(mv.values[i]));
+          if (not item)
+            throw string_builder("schema entry for key '")(key)
+              ("' should only contain enum items, found a ")(mv.values[i]->get_type()).str();
+
+          const std::string& token(item->get_token_value());
+          if (i == 0) {
+            if (token != "integer" and token != "real" and token != "boolean"
+                and token != "string" and token != "enum")
+              throw string_builder("unknown type '")(token)("' in schema entry for key '")(key)("'").str();
+            e.type = token;
+          } else if (token == "optional") {
+            e.is_optional = true;
+          } else if (e.type == "enum") {
+            e.enum_items.insert(token);
+          } else {
+            throw string_builder("unexpected item '#")(token)("' in schema entry for key '")(key)("'").str();
+          }
+        }
+
+        entries[key] = e;
+      }
+    }
+
+    void set_entry(const std::string& key, const entry& e) { entries[key] = e; }
+
+    void check(const collection& c, std::vector<diagnostic>& d) const {
+      const std::vector<std::string> keys(c.get_keys());
+      const std::set<std::string> defined_keys(keys.begin(), keys.end());
+
+      for (const auto& e: entries)
+        if (not e.second.is_optional and defined_keys.count(e.first) == 0)
+          d.push_back(diagnostic(diagnostic::severity::error,
+                                 "the required key '" + e.first + "' is not defined"));
+
+      for (const auto& key: keys) {
+        const auto e(entries.find(key));
+        if (e == entries.end()) {
+          d.push_back(diagnostic(diagnostic::severity::error,
+                                 "the key '" + key + "' is not declared in the schema"
+                                 + c.get_definition_location(key)));
+          continue;
+        }
+
+        std::set<std::string> visited;
+        check_values(c, defined_keys, key, key, e->second, visited, d);
+      }
+    }
+
+  private:
+    std::map<std::string, entry> entries;
+
+  private:
+    /*
+     * References are followed so that the type of the referenced values
+     * is checked against the entry of the referencing key.
+     */
+    void check_values(const collection& c,
+                      const std::set<std::string>& defined_keys,
+                      const std::string& key,
+                      const std::string& value_key,
+                      const entry& e,
+                      std::set<std::string>& visited,
+                      std::vector<diagnostic>& d) const {
+      if (not visited.insert(value_key).second)
+        return;
+
+      if (defined_keys.count(value_key) == 0)
+        return;
+
+      for (const auto v: c.get_multi_value(value_key).values) {
+        if (const value_ref* r = dynamic_cast<const value_ref*>(v)) {
+          check_values(c, defined_keys, key, r->get_key(), e, visited, d);
+          continue;
+        }
+
+        if (v->get_type() != e.type) {
+          d.push_back(diagnostic(diagnostic::severity::error,
+                                 string_builder("the key '")(key)("' should be of type ")(e.type)
+                                 (" but has a value ")(v->print_value())(" of type ")(v->get_type())
+                                 (c.get_definition_location(value_key)).str()));
+        } else if (e.type == "enum") {
+          const std::string& token(static_cast<const enum_value*>(v)->get_token_value());
+          if (e.enum_items.size() and e.enum_items.count(token) == 0) {
+            std::string enum_value_set;
+            for (const auto& item: e.enum_items)
+              enum_value_set += item + " ";
+            d.push_back(diagnostic(diagnostic::severity::error,
+                                   "the value '" + token + "' of the key '" + key
+                                   + "' is not among the enum value set { " + enum_value_set + "}"
+                                   + c.get_definition_location(value_key)));
+          }
+        }
+      }
+    }
+  };
+
+  struct file_report {
+    std::string filename;
+    std::vector<diagnostic> diagnostics;
+
+    std::size_t get_error_number() const {
+      return std::count_if(diagnostics.begin(), diagnostics.end(),
+                           [](const diagnostic& d) { return d.is_error(); });
+    }
+
+    std::size_t get_warning_number() const {
+      return diagnostics.size() - get_error_number();
+    }
+  };
+
+  /*
+   * Parse many files concurrently, each in its own collection, and
+   * collect every diagnostic instead of stopping at the first error.
+   */
+  class validator {
+  public:
+    validator()
+      : s(nullptr), thread_number(std::max(1u, std::thread::hardware_concurrency())) {}
+
+    void set_schema(const schema* sc) { s = sc; }
+    void set_thread_number(std::size_t n) { thread_number = std::max<std::size_t>(1, n); }
+
+    std::vector<file_report> validate(const std::vector<std::string>& filenames) const {
+      std::vector<file_report> reports(filenames.size());
+      std::atomic<std::size_t> next_file(0);
+
+      auto worker = [&]() {
+        for (std::size_t i(next_file++); i < filenames.size(); i = next_file++) {
+          reports[i].filename = filenames[i];
+          validate_file(filenames[i], reports[i].diagnostics);
+        }
+      };
+
+      std::vector<std::thread> threads;
+      for (std::size_t i(1); i < std::min(thread_number, filenames.size()); ++i)
+        threads.push_back(std::thread(worker));
+      worker();
+      for (auto& t: threads)
+        t.join();
+
+      return reports;
+    }
+
+    void validate_file(const std::string& filename, std::vector<diagnostic>& d) const {
+      collection c;
+      c.set_diagnostic_sink(&d);
+
+      try {
+        c.read_from_file(filename);
+      }
+      catch (const std::string& e) {
+        d.push_back(diagnostic(diagnostic::severity::error, e));
+        return;
+      }
+      catch (const std::exception& e) {
+        d.push_back(diagnostic(diagnostic::severity::error,
+                               "unexpected error while reading '" + filename + "': " + e.what()));
+        return;
+      }
+
+      c.check_references(d);
+
+      if (s)
+        s->check(c, d);
+    }
+
+  private:
+    const schema* s;
+    std::size_t thread_number;
+  };
+
+}
+
+#endif /* PARAMETER_VALIDATION_H */
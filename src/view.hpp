@@ -0,0 +1,162 @@
+#ifndef PARAMETER_VIEW_H
+#define PARAMETER_VIEW_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "parameter.hpp"
+
+namespace parameter {
+
+  /*
+   * Subset of the points of a collection, selected by the values of
+   * some keys, which is swept like a collection:
+   *
+   *   const collection_view slice(collection_view(c).fix("time-step", 0.01));
+   *   for (std::size_t i(0); i < slice.get_collection_size(); ++i) {
+   *     slice.set_current_collection(i);
+   *     post_process(c);
+   *   }
+   *
+   * A view only records the value ids kept in each dimension and
+   * selects the points in the collection it was built from, which must
+   * outlive it and whose keys must not be redefined meanwhile. Fixing
+   * a key costs its number of values, and selecting a point the number
+   * of dimensions, whatever the size of the collection. The points keep
+   * the order of the collection.
+   */
+  class collection_view {
+  public:
+    collection_view(collection& c)
+      : c(&c), strides(c.get_dimension_table().get_strides()), is_empty(false) {
+      const collection::dimension_table& d(c.get_dimension_table());
+      for (std::size_t id(0); id < d.get_dimension_number(); ++id) {
+        ids.push_back(collection::multi_index(d.get_size(id)));
+        for (std::size_t i(0); i < d.get_size(id); ++i)
+          ids.back()[i] = i;
+      }
+
+      // the fastest changing dimension of the collection comes first
+      for (std::size_t id(0); id < ids.size(); ++id)
+        order.push_back(id);
+      std::stable_sort(order.begin(), order.end(),
+                       [this](std::size_t a, std::size_t b) { return strides[a] < strides[b]; });
+    }
+
+    /*
+     * The points where the key takes the value.
+     */
+    template<typename value_type>
+    collection_view fix(const std::string& key, const value_type& v) const {
+      const collection::multi_value& mv(c->get_multi_value(key));
+      collection::multi_index matching;
+      for (std::size_t i(0); i < mv.get_value_number(); ++i) {
+        const value<value_type>* typed_v(dynamic_cast<const value<value_type>*>(mv.values[i]));
+        if (typed_v and typed_v->get_value() == v)
+          matching.push_back(i);
+      }
+
+      if (matching.empty())
+        throw string_builder("the key '")(key)("' never takes the value ")(v).str();
+      return restrict(key, matching);
+    }
+
+    collection_view fix(const std::string& key, const char* v) const {
+      return fix(key, std::string(v));
+    }
+
+    /*
+     * The points where the key takes one of the values of the given
+     * value ids.
+     */
+    collection_view restrict(const std::string& key, const std::vector<std::size_t>& value_ids) const {
+      const collection::multi_value& mv(c->get_multi_value(key));
+      for (const auto i: value_ids)
+        if (i >= mv.get_value_number())
+          throw string_builder("value id ")(i)(" out of the ")(mv.get_value_number())
+            (" values of the key '")(key)("'").str();
+
+      collection_view view(*this);
+      const std::size_t id(mv.get_index_id());
+      if (id == collection::dimension_table::no_dimension) {
+        // a single valued key is at its only value at every point
+        view.is_empty = view.is_empty or value_ids.empty();
+        return view;
+      }
+
+      check_dimensions();
+      collection::multi_index& kept(view.ids[id]);
+      kept.erase(std::remove_if(kept.begin(), kept.end(),
+                                [&value_ids](std::size_t i) {
+                                  return std::find(value_ids.begin(), value_ids.end(), i) == value_ids.end();
+                                }),
+                 kept.end());
+      view.is_empty = view.is_empty or kept.empty();
+      return view;
+    }
+
+    std::size_t get_collection_size() const {
+      if (is_empty)
+        return 0;
+
+      std::size_t size(1);
+      for (const auto& kept: ids)
+        size *= kept.size();
+      return size;
+    }
+
+    /*
+     * Point i of the view, as the value id selected in each dimension.
+     */
+    collection::multi_index get_point(std::size_t i) const {
+      check_dimensions();
+      if (i >= get_collection_size())
+        throw string_builder("point ")(i)(" out of the ")(get_collection_size())
+          (" points of the view").str();
+
+      collection::multi_index point(ids.size());
+      for (const auto id: order) {
+        point[id] = ids[id][i % ids[id].size()];
+        i /= ids[id].size();
+      }
+      return point;
+    }
+
+    /*
+     * Index in the collection of the point i of the view.
+     */
+    std::size_t get_collection_index(std::size_t i) const {
+      const collection::multi_index point(get_point(i));
+      std::size_t index(0);
+      for (std::size_t id(0); id < point.size(); ++id)
+        index += point[id] * strides[id];
+      return index;
+    }
+
+    void set_current_collection(std::size_t i) const {
+      c->set_current_point(get_point(i));
+    }
+
+    collection& get_collection() const { return *c; }
+
+  private:
+    collection* c;
+    collection::multi_index strides;
+
+    // value ids kept in each dimension of the collection, and the
+    // dimensions from the fastest changing one
+    std::vector<collection::multi_index> ids;
+    std::vector<std::size_t> order;
+    bool is_empty;
+
+  private:
+    void check_dimensions() const {
+      if (ids.size() != c->get_dimension_table().get_dimension_number())
+        throw std::string("the dimensions of the collection changed since the view was built");
+    }
+  };
+
+}
+
+#endif /* PARAMETER_VIEW_H */
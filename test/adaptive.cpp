@@ -0,0 +1,88 @@
+#include <map>
+#include <set>
+#include <utility>
+
+#include "../src/parameter.hpp"
+#include "../src/adaptive.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  /*
+   * Bisection of the time step between a stable and an unstable value,
+   * every point being evaluated exactly once.
+   */
+  void check_bisection() {
+    collection c;
+    c.read_from_string("n = 10, 20\n"
+                       "dt = 0.0, 1.0\n");
+    const double threshold(0.3);
+
+    adaptive_sweep sweep(c);
+    std::set<std::pair<int, double>> evaluated;
+    std::map<std::size_t, double> steps;
+    std::size_t stable_id(0), unstable_id(1), inserted_id(0), refinements(0);
+    while (sweep.next()) {
+      const std::pair<int, double> point(c.get_value<int>("n"), c.get_value<double>("dt"));
+      CHECK(evaluated.insert(point).second);
+      steps[sweep.get_value_id("dt")] = point.second;
+      if (sweep.get_pending_number())
+        continue;
+
+      // every point of the last value was evaluated
+      if (inserted_id) {
+        if (steps[inserted_id] < threshold)
+          stable_id = inserted_id;
+        else
+          unstable_id = inserted_id;
+      }
+      if (refinements < 6) {
+        inserted_id = sweep.insert_midpoint("dt", stable_id, unstable_id);
+        refinements += 1;
+      }
+    }
+
+    CHECK(sweep.get_evaluated_number() == 16 and evaluated.size() == 16);
+    CHECK(c.get_collection_size() == 16);
+    CHECK(steps[stable_id] == 0.296875 and steps[unstable_id] == 0.3125);
+
+    // appending values does not change the value ids
+    collection::multi_index point(c.get_current_point());
+    point[c.get_multi_value("dt").get_index_id()] = 1;
+    c.set_current_point(point);
+    CHECK(c.get_value<double>("dt") == 1.0);
+  }
+
+  void check_midpoint_errors() {
+    collection c;
+    c.read_from_string("n = 1, 2\n"
+                       "k = 1, 4\n"
+                       "name = \"a\", \"b\"\n");
+    adaptive_sweep sweep(c);
+    CHECK_THROWS(sweep.insert_midpoint("n", 0, 1), "no integer between the values 1 and 2");
+    CHECK_THROWS(sweep.insert_midpoint("k", 0, 2), "value id out of the 2 values");
+    CHECK_THROWS(sweep.insert_midpoint("name", 0, 1), "type string");
+    CHECK(sweep.insert_midpoint("k", 0, 1) == 2);
+    CHECK(c.get_multi_value("k").get_value_number() == 3);
+
+    // appended values keep the type of the key
+    CHECK_THROWS(c.append_key_value("k", 2.5), "type real");
+    CHECK_THROWS(c.append_key_value("name", true), "type boolean");
+    CHECK_THROWS(sweep.insert_value("n", "3"), "type string");
+    CHECK(c.get_multi_value("n").get_value_number() == 2);
+  }
+
+}
+
+int main() {
+  try {
+    check_bisection();
+    check_midpoint_errors();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,60 @@
+#ifndef PARAMETER_TEST_CHECK_H
+#define PARAMETER_TEST_CHECK_H
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+/*
+ * Minimal checks for the test programs: a failed check is reported
+ * with its location, and the program exits with the number of failed
+ * checks.
+ */
+namespace parameter_test {
+
+  inline int& failures() {
+    static int n(0);
+    return n;
+  }
+
+  inline void fail(const char* file, int line, const std::string& message) {
+    std::cerr << file << ":" << line << ": check failed: " << message << std::endl;
+    failures() += 1;
+  }
+
+  /*
+   * Temporary directory holding the files of a test, named after the
+   * test and the process.
+   */
+  inline std::string make_directory(const std::string& name) {
+    std::string path("/tmp/parameter-" + name + "-XXXXXX");
+    if (not mkdtemp(&path[0])) {
+      std::cerr << "failed to create a temporary directory" << std::endl;
+      std::exit(1);
+    }
+    return path;
+  }
+
+}
+
+#define CHECK(condition)                                                \
+  do {                                                                  \
+    if (not (condition))                                                \
+      parameter_test::fail(__FILE__, __LINE__, #condition);             \
+  } while (false)
+
+// the statement throws a std::string containing the text
+#define CHECK_THROWS(statement, text)                                   \
+  do {                                                                  \
+    try {                                                               \
+      statement;                                                        \
+      parameter_test::fail(__FILE__, __LINE__, #statement " did not throw"); \
+    } catch (const std::string& e) {                                    \
+      if (e.find(text) == std::string::npos)                            \
+        parameter_test::fail(__FILE__, __LINE__, #statement " threw '" + e + "'"); \
+    }                                                                   \
+  } while (false)
+
+#endif /* PARAMETER_TEST_CHECK_H */
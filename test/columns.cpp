@@ -0,0 +1,108 @@
+#include <thread>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  const char* const sweep_definitions =
+    "n = 1, 2, 3\n"
+    "k = 4, 5\n"
+    "dt = 0.1, 0.2\n"
+    "name = \"run-{n}-{k}\"\n"
+    "alias = name\n"
+    "path = \"{alias}/{dt}\"\n"
+    "r = n\n"
+    "steps = 10\n";
+
+  /*
+   * A column holds the values get_value gives at each point, and the
+   * current point is kept.
+   */
+  void check_columns() {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    const std::size_t point_number(c.get_collection_size());
+    c.set_current_collection(3);
+    const collection::multi_index point(c.get_current_point());
+
+    std::vector<std::string> paths(point_number), names(point_number);
+    std::vector<int> r(point_number), steps(point_number);
+    std::vector<double> dt(point_number);
+    c.evaluate_column("path", 0, point_number, paths.data());
+    c.evaluate_column("alias", 0, point_number, names.data());
+    c.evaluate_column("r", 0, point_number, r.data());
+    c.evaluate_column("steps", 0, point_number, steps.data());
+    c.evaluate_column("dt", 0, point_number, dt.data());
+    CHECK(c.get_current_point() == point);
+
+    std::vector<double> some(3);
+    c.evaluate_column("dt", std::vector<std::size_t>{5, 0, 5}, some.data());
+    std::vector<int> last(2);
+    c.evaluate_column("r", point_number - 2, point_number, last.data());
+
+    for (std::size_t i(0); i < point_number; ++i) {
+      c.set_current_collection(i);
+      CHECK(paths[i] == c.get_value<std::string>("path"));
+      CHECK(names[i] == c.get_value<std::string>("name"));
+      CHECK(r[i] == c.get_value<int>("n"));
+      CHECK(steps[i] == 10);
+      CHECK(dt[i] == c.get_value<double>("dt"));
+    }
+    CHECK(some[0] == dt[5] and some[1] == dt[0] and some[2] == dt[5]);
+    CHECK(last[0] == r[point_number - 2] and last[1] == r[point_number - 1]);
+
+    CHECK_THROWS(c.evaluate_column("name", 0, point_number, r.data()), "type string");
+  }
+
+  /*
+   * Columns evaluated concurrently neither change the current point
+   * nor see each other's points.
+   */
+  void check_concurrent_columns() {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    const std::size_t point_number(c.get_collection_size());
+
+    std::vector<std::string> expected(point_number);
+    for (std::size_t i(0); i < point_number; ++i) {
+      c.set_current_collection(i);
+      expected[i] = c.get_value<std::string>("path");
+    }
+
+    c.set_current_collection(5);
+    const collection::multi_index point(c.get_current_point());
+    const std::string current(c.get_value<std::string>("alias"));
+    std::vector<int> same(4, 1);
+    std::vector<std::thread> threads;
+    for (std::size_t t(0); t < same.size(); ++t)
+      threads.emplace_back([&c, &expected, &current, &same, t, point_number]() {
+          for (std::size_t j(0); j < 200; ++j) {
+            std::vector<std::string> column(point_number);
+            c.evaluate_column("path", 0, point_number, column.data());
+            if (column != expected or c.get_value<std::string>("alias") != current)
+              same[t] = 0;
+          }
+        });
+    for (auto& t: threads)
+      t.join();
+
+    for (const auto s: same)
+      CHECK(s);
+    CHECK(c.get_current_point() == point);
+  }
+
+}
+
+int main() {
+  try {
+    check_columns();
+    check_concurrent_columns();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
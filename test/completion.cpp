@@ -0,0 +1,88 @@
+#include <atomic>
+#include <thread>
+
+#include <sys/wait.h>
+
+#include "../src/completion.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  void check_marks(const std::string& directory) {
+    completion_tracker t(130, directory + "/marks.done");
+    CHECK(t.count_done() == 0 and t.next_unfinished() == 0);
+
+    CHECK(t.mark_done(0));
+    CHECK(not t.mark_done(0));
+    for (std::size_t i(1); i < 129; ++i)
+      t.mark_done(i);
+    CHECK(t.is_done(64) and not t.is_done(129));
+    CHECK(t.count_done() == 129);
+    CHECK(t.next_unfinished() == 129);
+    CHECK(t.next_unfinished(129) == 129);
+
+    t.mark_done(129);
+    CHECK(t.next_unfinished() == 130);
+    CHECK(t.next_unfinished(200) == 130);
+    CHECK_THROWS(t.mark_done(130), "out of range");
+  }
+
+  /*
+   * The bits set by a process which dies without syncing are found by
+   * the next one.
+   */
+  void check_crash(const std::string& directory) {
+    const std::string path(directory + "/crash.done");
+    const pid_t pid(fork());
+    if (pid == 0) {
+      completion_tracker t(1000, path);
+      for (std::size_t i(0); i < 1000; i += 3)
+        t.mark_done(i);
+      _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+
+    completion_tracker t(1000, path);
+    CHECK(t.count_done() == 334);
+    CHECK(t.next_unfinished() == 1 and t.next_unfinished(2) == 2 and t.next_unfinished(3) == 4);
+
+    CHECK_THROWS(completion_tracker(999, path), "does not record a sweep of 999 points");
+  }
+
+  /*
+   * Each point is claimed by exactly one of the threads marking it.
+   */
+  void check_concurrent_marks(const std::string& directory) {
+    completion_tracker t(10000, directory + "/concurrent.done");
+    std::atomic<std::size_t> claimed(0);
+    std::vector<std::thread> threads;
+    for (std::size_t k(0); k < 4; ++k)
+      threads.push_back(std::thread([&]() {
+            for (std::size_t i(0); i < t.get_point_number(); ++i)
+              claimed += t.mark_done(i);
+          }));
+    for (auto& thread: threads)
+      thread.join();
+
+    CHECK(claimed == 10000);
+    CHECK(t.count_done() == 10000);
+    t.sync();
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("completion"));
+  try {
+    check_marks(directory);
+    check_crash(directory);
+    check_concurrent_marks(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,156 @@
+#include <set>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  /*
+   * Only keys with several values take a dimension.
+   */
+  void check_trivial_dimensions() {
+    collection c;
+    c.read_from_string("a = 1\n"
+                       "b = 1, 2, 3\n"
+                       "c = \"x\"\n"
+                       "d = true, false\n");
+    CHECK(c.get_dimension_table().get_dimension_number() == 2);
+    CHECK(c.get_collection_size() == 6);
+
+    c.set_current_collection(5);
+    CHECK(c.get_value<int>("a") == 1);
+    CHECK(c.get_value<int>("b") == 3);
+    CHECK(c.get_value<bool>("d") == false);
+  }
+
+  /*
+   * A redefinition kills the dimension of the old values, which is
+   * removed at the end of the read.
+   */
+  void check_dead_dimensions() {
+    collection c;
+    c.read_from_string("a = 1, 2, 3\n"
+                       "b = 4, 5\n"
+                       "override a = 7\n");
+    CHECK(c.get_dimension_table().get_dimension_number() == 1);
+    CHECK(not c.get_dimension_table().has_dead_dimensions());
+    CHECK(c.get_collection_size() == 2);
+    c.set_current_collection(1);
+    CHECK(c.get_value<int>("a") == 7);
+    CHECK(c.get_value<int>("b") == 5);
+
+    // the public setters compact the table too
+    c.set_key_value("b", 1);
+    CHECK(c.get_dimension_table().get_dimension_number() == 0);
+    CHECK(c.get_collection_size() == 1);
+    CHECK(c.get_value<int>("b") == 1);
+  }
+
+  /*
+   * Redefining one key of a group leaves the other keys sweeping
+   * their values.
+   */
+  void check_group_redefinition() {
+    collection c;
+    c.read_from_string("[ x = 1, 2, 3\n"
+                       "  y = 4, 5, 6 ]\n"
+                       "override x = 0\n");
+    CHECK(c.get_dimension_table().get_dimension_number() == 1);
+    CHECK(c.get_collection_size() == 3);
+    for (std::size_t i(0); i < 3; ++i) {
+      c.set_current_collection(i);
+      CHECK(c.get_value<int>("x") == 0);
+      CHECK(c.get_value<int>("y") == static_cast<int>(4 + i));
+    }
+
+    c.read_from_string("override y = 9\n");
+    CHECK(c.get_dimension_table().get_dimension_number() == 0);
+    CHECK(c.get_collection_size() == 1);
+  }
+
+  const char* const cost_definitions =
+    "mesh = 8, 16, 32\n"
+    "[ solver = #cg, #gmres\n"
+    "  tolerance = 1e-6, 1e-8 ]\n"
+    "dt = 0.1, 0.2, 0.4, 0.8\n";
+
+  /*
+   * Points with the same projection index share the values of the
+   * projected keys, and the indices cover [0, size).
+   */
+  void check_projection_index() {
+    collection c;
+    c.read_from_string(cost_definitions);
+    const std::vector<std::string> keys = {"mesh", "tolerance"};
+    CHECK(c.get_projection_size(keys) == 6);
+    CHECK(c.get_projection_size({"dt"}) == 4);
+    CHECK(c.get_projection_size({}) == 1);
+
+    std::vector<std::set<std::string> > values(c.get_projection_size(keys));
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      const std::size_t index(c.projection_index(keys));
+      CHECK(index < values.size());
+      CHECK(c.projection_index({"dt"}) == c.get_current_point()[c.get_dimension_table().get_dimension_number() - 1]);
+      values[index].insert(std::to_string(c.get_value<int>("mesh")) + " " + c.get_enum_token("solver"));
+    }
+    for (const auto& v: values)
+      CHECK(v.size() == 1);
+  }
+
+  std::size_t count_changes(collection& c, const std::string& key) {
+    std::size_t changes(0);
+    c.set_current_collection(0);
+    std::string previous(c.get_basic_value(key)->print_value());
+    for (std::size_t i(1); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      const std::string current(c.get_basic_value(key)->print_value());
+      changes += current != previous;
+      previous = current;
+    }
+    return changes;
+  }
+
+  /*
+   * The most expensive dimension changes least often, the costs of a
+   * group are shared and follow the keys through redefinitions.
+   */
+  void check_dimension_costs() {
+    collection c;
+    c.read_from_string(cost_definitions);
+    const std::vector<std::vector<std::string> > definition_order(c.get_iteration_order());
+
+    c.set_dimension_cost("mesh", 100.);
+    c.set_dimension_cost("tolerance", 10.);
+    CHECK(count_changes(c, "mesh") == 2);
+    CHECK(count_changes(c, "solver") == 5);
+    CHECK(count_changes(c, "dt") == 23);
+    CHECK((c.get_iteration_order() == std::vector<std::vector<std::string> >{
+          {"mesh"}, {"solver", "tolerance"}, {"dt"}}));
+
+    c.read_from_string("override mesh = 4, 8\n");
+    CHECK(c.get_iteration_order().front() == std::vector<std::string>{"mesh"});
+    CHECK(count_changes(c, "mesh") == 1);
+
+    c.reset_dimension_costs();
+    c.read_from_string("override mesh = 8, 16, 32\n");
+    CHECK(c.get_iteration_order() == definition_order);
+  }
+
+}
+
+int main() {
+  try {
+    check_trivial_dimensions();
+    check_dead_dimensions();
+    check_group_redefinition();
+    check_projection_index();
+    check_dimension_costs();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,102 @@
+#include "../src/embedded.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  enum class boundary { dirichlet, neumann };
+
+  constexpr const char defaults_text[] = R"(
+    ; embedded defaults
+    space-subdivisions = 100
+    final-time = 1.5
+    tolerance: 2.5e-8
+    verbose -> off
+    left-bc-type = #dirichlet
+    output-prefix = "run-{space-subdivisions}"
+    label = "plain"
+    physics.viscosity = -0.125
+  )";
+
+  constexpr auto defaults(make_embedded_parameters<count_embedded_parameters(defaults_text)>(defaults_text));
+
+  constexpr std::pair<const char*, boundary> boundaries[] = {
+    {"dirichlet", boundary::dirichlet}, {"neumann", boundary::neumann}
+  };
+
+  // evaluated by the compiler
+  static_assert(defaults.get_size() == 8, "");
+  static_assert(defaults.get<int>("space-subdivisions") == 100, "");
+  static_assert(defaults.get<double>("final-time") == 1.5, "");
+  static_assert(defaults.get<double>("physics.viscosity") == -0.125, "");
+  static_assert(not defaults.get<bool>("verbose"), "");
+  static_assert(defaults.get<embedded_string>("label") == "plain", "");
+  static_assert(defaults.get_enum("left-bc-type", boundaries) == boundary::dirichlet, "");
+  static_assert(defaults.contains("tolerance") and not defaults.contains("tol"), "");
+
+  /*
+   * The values converted at compile time are the ones the runtime
+   * parser reads.
+   */
+  void check_runtime_equality() {
+    collection parsed;
+    parsed.read_from_string(defaults_text);
+    collection installed;
+    defaults.install(installed);
+
+    CHECK(installed.get_keys() == parsed.get_keys());
+    CHECK(installed.get_value<double>("tolerance") == parsed.get_value<double>("tolerance"));
+    CHECK(installed.get_value<double>("tolerance") == defaults.get<double>("tolerance"));
+    CHECK(installed.get_value<std::string>("output-prefix") == "run-100");
+    CHECK(installed.get_enum_token("left-bc-type") == "dirichlet");
+  }
+
+  /*
+   * install lets the files override the defaults, fill keeps the
+   * values the files define.
+   */
+  void check_install_and_fill() {
+    collection c;
+    defaults.install(c);
+    c.read_from_string("override space-subdivisions = 200, 400\n");
+    CHECK(c.get_collection_size() == 2);
+    c.set_current_collection(1);
+    CHECK(c.get_value<std::string>("output-prefix") == "run-400");
+
+    collection d;
+    d.read_from_string("final-time = 3.0\n");
+    defaults.fill(d);
+    CHECK(d.get_value<double>("final-time") == 3.);
+    CHECK(d.get_value<int>("space-subdivisions") == 100);
+  }
+
+  /*
+   * Outside of a constant expression, the errors are thrown.
+   */
+  void check_errors() {
+    CHECK_THROWS(defaults.get<int>("final-time"), "");
+    CHECK_THROWS(defaults.get<int>("missing"), "");
+    CHECK_THROWS(defaults.get<embedded_string>("output-prefix"), "can only be read from a collection");
+
+    const char* lists("n = 1, 2\n");
+    CHECK_THROWS(count_embedded_parameters(lists), "value lists are not supported");
+    const char* references("n = m\n");
+    CHECK_THROWS(count_embedded_parameters(references), "references to other keys");
+    const char* duplicates("n = 1\nn = 2\n");
+    CHECK_THROWS((embedded_parameters<2>(duplicates)), "duplicate key");
+  }
+
+}
+
+int main() {
+  try {
+    check_runtime_equality();
+    check_install_and_fill();
+    check_errors();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
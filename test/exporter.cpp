@@ -0,0 +1,199 @@
+#include <cstring>
+#include <sstream>
+
+#include "../src/parameter.hpp"
+#include "../src/exporter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  // name is formatted once per combination of n and solver, path at
+  // each point
+  const char* const sweep_definitions =
+    "n = 1, 2, 3, 4, 5\n"
+    "dt = 0.1, 1e-7, 1.0\n"
+    "solver = #cg, #gmres\n"
+    "[ label = \"a,b\", \"c\\\"d\"\n"
+    "  flag = true, false ]\n"
+    "name = \"run-{n}-{solver}\"\n"
+    "path = \"{name}/{dt}/{label}\"\n"
+    "r = n\n"
+    "third = 0.3333333333333333\n";
+
+  std::string export_collection(const collection& c, exporter::format f,
+                                std::size_t thread_number, std::size_t chunk_size) {
+    exporter e(f);
+    e.set_thread_number(thread_number);
+    e.set_chunk_size(chunk_size);
+    std::ostringstream stream;
+    e.write(c, stream);
+    return stream.str();
+  }
+
+  std::vector<std::string> split_lines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line))
+      lines.push_back(line);
+    return lines;
+  }
+
+  /*
+   * Each CSV line and JSON object holds the values get_value gives at
+   * its point, the reals reading back to the same double.
+   */
+  void check_text_formats(const collection& c) {
+    collection reference(c);
+    const std::vector<std::string> csv(split_lines(export_collection(c, exporter::format::csv, 4, 7)));
+    const std::vector<std::string> json(split_lines(export_collection(c, exporter::format::json_lines, 4, 7)));
+    CHECK(csv.size() == c.get_collection_size() + 1);
+    CHECK(json.size() == c.get_collection_size());
+    CHECK(csv.front() == "dt,flag,label,n,name,path,r,solver,third");
+
+    for (std::size_t i(0); i + 1 < csv.size() and i < json.size(); ++i) {
+      reference.set_current_collection(i);
+      const std::string label(reference.get_value<std::string>("label"));
+      const std::string csv_label(label.find(',') != std::string::npos ? "\"a,b\"" : "\"c\"\"d\"");
+      const std::string json_label(label.find(',') != std::string::npos ? "\"a,b\"" : "\"c\\\"d\"");
+
+      std::string dt;
+      append_real(dt, reference.get_value<double>("dt"));
+      CHECK(std::strtod(dt.c_str(), nullptr) == reference.get_value<double>("dt"));
+
+      const std::string flag(reference.get_value<bool>("flag") ? "true" : "false");
+      const std::string n(std::to_string(reference.get_value<int>("n")));
+      const std::string name(reference.get_value<std::string>("name"));
+      const std::string path(reference.get_value<std::string>("path"));
+      const std::string solver(reference.get_enum_token("solver"));
+
+      std::string csv_path("\"");
+      for (const char ch: path)
+        csv_path += ch == '"' ? std::string("\"\"") : std::string(1, ch);
+      csv_path += '"';
+      CHECK(csv[i + 1] == dt + "," + flag + "," + csv_label + "," + n + "," + name + "," + csv_path
+            + "," + n + "," + solver + ",0.3333333333333333");
+
+      std::string json_path;
+      append_json_string(json_path, path);
+      CHECK(json[i] == "{\"dt\":" + dt + ",\"flag\":" + flag + ",\"label\":" + json_label + ",\"n\":" + n
+            + ",\"name\":\"" + name + "\",\"path\":" + json_path + ",\"r\":" + n
+            + ",\"solver\":\"" + solver + "\",\"third\":0.3333333333333333}");
+    }
+  }
+
+  template<typename pod_type>
+  pod_type read_pod(const std::string& data, std::size_t& offset) {
+    pod_type v;
+    std::memcpy(&v, data.data() + offset, sizeof(pod_type));
+    offset += sizeof(pod_type);
+    return v;
+  }
+
+  /*
+   * Read the binary table back, row group by row group, and compare
+   * every value to get_value.
+   */
+  void check_binary_format(const collection& c) {
+    collection reference(c);
+    const std::string data(export_collection(c, exporter::format::binary, 3, 4));
+    CHECK(data.compare(0, 8, "PRMTAB01") == 0);
+
+    std::size_t offset(8);
+    const std::size_t column_number(read_pod<std::uint64_t>(data, offset));
+    std::vector<std::string> names;
+    std::vector<std::uint8_t> types;
+    for (std::size_t k(0); k < column_number; ++k) {
+      types.push_back(read_pod<std::uint8_t>(data, offset));
+      const std::uint32_t size(read_pod<std::uint32_t>(data, offset));
+      names.push_back(data.substr(offset, size));
+      offset += size;
+    }
+    CHECK(names.size() == 9 and names[0] == "dt" and names[8] == "third");
+
+    std::size_t point(0);
+    while (true) {
+      const std::size_t n(read_pod<std::uint64_t>(data, offset));
+      if (n == 0)
+        break;
+
+      for (std::size_t k(0); k < column_number; ++k) {
+        std::vector<std::string> values(n);
+        if (types[k] == 3 or types[k] == 4) {
+          std::vector<std::uint64_t> offsets(n + 1);
+          for (auto& o: offsets)
+            o = read_pod<std::uint64_t>(data, offset);
+          for (std::size_t i(0); i < n; ++i)
+            values[i] = data.substr(offset + offsets[i], offsets[i + 1] - offsets[i]);
+          offset += offsets.back();
+        }
+
+        for (std::size_t i(0); i < n; ++i) {
+          reference.set_current_collection(point + i);
+          switch (types[k]) {
+          case 0:
+            CHECK(read_pod<std::int32_t>(data, offset) == reference.get_value<int>(names[k]));
+            break;
+          case 1:
+            CHECK(read_pod<double>(data, offset) == reference.get_value<double>(names[k]));
+            break;
+          case 2:
+            CHECK(read_pod<std::uint8_t>(data, offset) == reference.get_value<bool>(names[k]));
+            break;
+          case 3:
+            CHECK(values[i] == reference.get_value<std::string>(names[k]));
+            break;
+          case 4:
+            CHECK(values[i] == reference.get_enum_token(names[k]));
+            break;
+          }
+        }
+      }
+      point += n;
+    }
+    CHECK(point == c.get_collection_size());
+    CHECK(read_pod<std::uint64_t>(data, offset) == point);
+    CHECK(offset == data.size());
+  }
+
+  // the row groups of the binary table follow the chunks
+  void check_threads(const collection& c) {
+    for (const auto f: {exporter::format::csv, exporter::format::json_lines}) {
+      const std::string serial(export_collection(c, f, 1, 1000));
+      CHECK(export_collection(c, f, 4, 1) == serial);
+      CHECK(export_collection(c, f, 3, 5) == serial);
+    }
+    CHECK(export_collection(c, exporter::format::binary, 4, 5)
+          == export_collection(c, exporter::format::binary, 1, 5));
+  }
+
+  void check_type_change() {
+    collection c;
+    c.read_from_string("x = 1, 2.5\n");
+    exporter e(exporter::format::binary);
+    std::ostringstream stream;
+    CHECK_THROWS(e.write(c, stream), "has a value of type real at point 1");
+  }
+
+}
+
+int main() {
+  try {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    c.set_current_collection(7);
+
+    check_text_formats(c);
+    check_binary_format(c);
+    check_threads(c);
+    CHECK(c.get_current_point() == collection(c).get_current_point());
+    CHECK(c.get_value<int>("n") == 3);
+    check_type_change();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,136 @@
+#include <cstdlib>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include "../src/parameter.hpp"
+#include "../src/fingerprint.hpp"
+#include "../src/result_store.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  /*
+   * The fingerprint of a point only depends on the resolved values,
+   * and the incremental update gives the fingerprint computed from
+   * scratch.
+   */
+  void check_point_fingerprints() {
+    collection c;
+    c.read_from_string("n = 1, 2, 3\n"
+                       "dt = 0.1, 0.2\n"
+                       "name = \"run-{n}\"\n");
+    collection same;
+    same.read_from_string("dt = 0.1, 0.2\n"
+                          "m = 1, 2, 3\n"
+                          "n = m\n"
+                          "name = \"run-{m}\"\n");
+
+    point_fingerprinter fp(c);
+    point_fingerprinter same_fp(same, std::vector<std::string>{"n", "dt", "name"});
+    std::set<std::string> fingerprints, same_fingerprints;
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      const fingerprint f(fp.get());
+      CHECK(f.to_string() == point_fingerprinter(c).get().to_string());
+      fingerprints.insert(f.to_string());
+
+      // the points of the two files are not in the same order
+      same.set_current_collection(i);
+      same_fingerprints.insert(same_fp.get().to_string());
+    }
+    CHECK(fingerprints.size() == c.get_collection_size());
+    CHECK(fingerprints == same_fingerprints);
+  }
+
+  void check_store(const std::string& directory) {
+    result_store store(directory + "/results");
+    collection c;
+    c.read_from_string("a = 1, 2\n");
+    point_fingerprinter fp(c);
+    const fingerprint first(fp.get());
+    c.set_current_collection(1);
+    const fingerprint second(fp.get());
+
+    std::string result;
+    CHECK(not store.contains(first) and not store.load(first, result));
+    store.store(first, "first");
+    CHECK(store.contains(first) and not store.contains(second));
+    CHECK(store.load(first, result) and result == "first");
+    CHECK(store.get_path(first).find(directory + "/results/" + first.to_string().substr(0, 2) + "/")
+          == 0);
+    store.remove(first);
+    CHECK(not store.contains(first));
+  }
+
+  /*
+   * Threads storing the same point never leave a mixed or partial
+   * result behind.
+   */
+  void check_concurrent_store(const std::string& directory) {
+    result_store store(directory + "/concurrent");
+    collection c;
+    c.read_from_string("a = 1, 2\n");
+    point_fingerprinter fp(c);
+    const fingerprint f(fp.get());
+
+    std::vector<std::thread> threads;
+    for (char t(0); t < 4; ++t)
+      threads.emplace_back([&store, &f, t]() {
+          for (std::size_t i(0); i < 100; ++i)
+            store.store(f, std::string(4096, 'a' + t));
+        });
+    for (auto& t: threads)
+      t.join();
+
+    std::string result;
+    CHECK(store.load(f, result));
+    CHECK(result.size() == 4096 and result.find_first_not_of(result[0]) == std::string::npos);
+  }
+
+  /*
+   * The elements of a table column are encoded as 8 little endian
+   * bytes each, whatever the byte order of the host.
+   */
+  void check_column_fingerprint(const std::string& directory) {
+    std::ofstream(directory + "/t.csv") << "x\n1\n-2\n300000\n";
+    std::ofstream(directory + "/t.conf") << "import #csv \"t.csv\" -> t\n";
+
+    collection c;
+    c.read_from_file(directory + "/t.conf");
+    point_fingerprinter fp(c);
+    const std::string bytes(fp.encode("t-x"));
+
+    std::string expected;
+    const auto append = [&expected](std::uint64_t x) {
+      for (std::size_t i(0); i < 8; ++i)
+        expected += static_cast<char>((x >> (8 * i)) & 0xff);
+    };
+    append(3);
+    expected += "t-x";
+    expected += 'I';
+    append(3);
+    append(1);
+    append(static_cast<std::uint64_t>(std::int64_t(-2)));
+    append(300000);
+    CHECK(bytes == expected);
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("fingerprints"));
+  try {
+    check_point_fingerprints();
+    check_store(directory);
+    check_concurrent_store(directory);
+    check_column_fingerprint(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  std::system(("rm -rf " + directory).c_str());
+  return parameter_test::failures();
+}
@@ -0,0 +1,120 @@
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+  }
+
+  struct load_result {
+    std::string points;
+    std::vector<std::string> diagnostics;
+    std::string error;
+
+    bool operator==(const load_result& r) const {
+      return points == r.points and diagnostics == r.diagnostics and error == r.error;
+    }
+  };
+
+  load_result load(const std::string& path, bool parallel, bool lazy, bool sink) {
+    collection c;
+    c.set_parallel_imports(parallel);
+    c.set_lazy_loading(lazy);
+    std::vector<diagnostic> d;
+    if (sink)
+      c.set_diagnostic_sink(&d);
+
+    load_result r;
+    try {
+      c.read_from_file(path);
+      std::ostringstream stream;
+      for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+        c.set_current_collection(i);
+        c.print_key_values(stream);
+      }
+      r.points = stream.str();
+    } catch (const std::string& e) {
+      r.error = e;
+    }
+    for (const auto& x: d) {
+      std::ostringstream stream;
+      stream << x;
+      r.diagnostics.push_back(stream.str());
+    }
+    return r;
+  }
+
+  /*
+   * Imports relative to the importing file, a file imported twice,
+   * redefinitions, overrides and a recovered error in an import.
+   */
+  void write_tree(const std::string& directory) {
+    mkdir((directory + "/physics").c_str(), 0755);
+    write_file(directory + "/main.conf",
+               "n = 1, 2\n"
+               "import \"physics/fluid.conf\"\n"
+               "import \"mesh.conf\"\n"
+               "[ a = 1, 2\n"
+               "  b = 3, 4 ]\n"
+               "override nu = 2e-6\n"
+               "import \"mesh.conf\"\n"
+               "name = \"run-{n}-{cells}\"\n");
+    write_file(directory + "/physics/fluid.conf",
+               "nu = 1e-6\n"
+               "import \"constants.conf\"\n"
+               "rho = 1000.\n");
+    write_file(directory + "/physics/constants.conf",
+               "g = 9.81\n");
+    write_file(directory + "/mesh.conf",
+               "cells = 64, 128\n"
+               "bad = = 1\n"
+               "refine = #uniform\n");
+  }
+
+  /*
+   * The parallel parse applies the statements as the sequential one,
+   * with the same diagnostics, with and without lazy loading.
+   */
+  void check_sequential_equality(const std::string& directory) {
+    const std::string path(directory + "/main.conf");
+    const load_result sequential(load(path, false, false, true));
+    CHECK(sequential.error.empty());
+    CHECK(sequential.diagnostics.size() == 4);
+    CHECK(sequential.points.size());
+
+    CHECK(load(path, true, false, true) == sequential);
+    CHECK(load(path, true, true, true) == sequential);
+
+    // without a sink the first error is thrown
+    const load_result thrown(load(path, false, false, false));
+    CHECK(thrown.error.size());
+    CHECK(load(path, true, false, false) == thrown);
+  }
+
+  void check_cycle(const std::string& directory) {
+    write_file(directory + "/cycle-a.conf", "x = 1\nimport \"cycle-b.conf\"\n");
+    write_file(directory + "/cycle-b.conf", "import \"cycle-a.conf\"\n");
+    CHECK(load(directory + "/cycle-a.conf", true, false, false).error.find("circular import") != std::string::npos);
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("imports"));
+  try {
+    write_tree(directory);
+    check_sequential_equality(directory);
+    check_cycle(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
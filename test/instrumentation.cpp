@@ -0,0 +1,92 @@
+#include <thread>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  /*
+   * The memory accounting sums the footprint of every key, and longer
+   * strings weigh more.
+   */
+  void check_memory_usage() {
+    collection c;
+    c.read_from_string("n = 1, 2, 3\n"
+                       "short = \"a\"\n"
+                       "long = \"a string too long to be stored in place\"\n");
+
+    const memory_usage usage(c.get_memory_usage());
+    CHECK(usage.by_key.size() == 3);
+    CHECK(usage.by_key.at("long") > usage.by_key.at("short"));
+    CHECK(usage.by_kind.count("integer") and usage.by_kind.count("string") and usage.by_kind.count("index"));
+
+    std::size_t key_total(0);
+    for (const auto& k: usage.by_key)
+      key_total += k.second;
+    CHECK(usage.total > key_total);
+  }
+
+  /*
+   * Without PARAMETER_INSTRUMENTATION in the library, the reads are not
+   * recorded and the queries relying on them refuse to answer.
+   */
+  void check_unavailable() {
+    collection c;
+    c.read_from_string("n = 1\n");
+    CHECK_THROWS(c.enable_instrumentation(), "compiled without");
+    CHECK(not c.get_instrumentation().is_enabled());
+    CHECK_THROWS(c.get_unread_keys(), "not enabled");
+  }
+
+  /*
+   * Reads from several threads are all counted.
+   */
+  void check_concurrent_reads() {
+    collection c;
+    c.read_from_string("n = 1, 2\n"
+                       "name = \"run-{n}\"\n"
+                       "path = \"{name}/out\"\n"
+                       "unused = 0\n");
+    c.enable_instrumentation();
+
+    const std::size_t thread_number(4), read_number(1000);
+    std::vector<std::thread> threads;
+    for (std::size_t t(0); t < thread_number; ++t)
+      threads.emplace_back([&c, read_number]() {
+          for (std::size_t i(0); i < read_number; ++i) {
+            c.get_value<int>("n");
+            c.get_value<std::string>("path");
+          }
+        });
+    for (auto& t: threads)
+      t.join();
+
+    const auto keys(c.get_instrumentation().get_key_statistics());
+    CHECK(keys.at("n").get_value_calls == thread_number * read_number);
+    CHECK(keys.at("path").get_value_calls == thread_number * read_number);
+    CHECK(keys.at("path").max_interpolation_depth == 2);
+    CHECK((c.get_unread_keys() == std::vector<std::string>{"unused"}));
+
+    // a copy keeps the statistics of the collection it was copied from
+    const collection copy(c);
+    CHECK(copy.get_instrumentation().get_key_statistics().at("n").get_value_calls
+          == thread_number * read_number);
+  }
+
+}
+
+int main() {
+  try {
+    check_memory_usage();
+    if (instrumentation::is_available())
+      check_concurrent_reads();
+    else
+      check_unavailable();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
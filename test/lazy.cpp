@@ -0,0 +1,134 @@
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+  }
+
+  std::string print_points(collection& c) {
+    std::ostringstream stream;
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      c.print_key_values(stream);
+    }
+    return stream.str();
+  }
+
+  /*
+   * The lazily loaded collection reads as the parsed one.
+   */
+  void check_equality(const std::string& directory) {
+    write_file(directory + "/common.conf",
+               "dt = 0.1, 1e-3 ; time step\n"
+               "solver -> #cg\n");
+    write_file(directory + "/main.conf",
+               "import \"common.conf\"\n"
+               "n = 1, 2, 3\n"
+               "[ flag = true, off\n"
+               "  label: \"a \\\"b\\\"\", \"c\\\\d\" ]\n"
+               "prefix = \"run-{n}-{dt}\"\n"
+               "m = n\n"
+               "override solver = #gmres\n"
+               "x = -.5, +4, 5., 2E-2\n");
+
+    collection parsed;
+    parsed.read_from_file(directory + "/main.conf");
+
+    collection lazy;
+    lazy.set_lazy_loading(true);
+    CHECK(lazy.is_lazy_loading());
+    lazy.read_from_file(directory + "/main.conf");
+
+    CHECK(lazy.get_collection_size() == parsed.get_collection_size());
+    CHECK(print_points(lazy) == print_points(parsed));
+
+    // a copy keeps the values which are not converted yet
+    collection copy;
+    copy.set_lazy_loading(true);
+    copy.read_from_file(directory + "/main.conf");
+    const collection unconverted(copy);
+    collection converted(unconverted);
+    CHECK(print_points(converted) == print_points(parsed));
+    CHECK(print_points(copy) == print_points(parsed));
+  }
+
+  /*
+   * A value is only converted when its key is accessed.
+   */
+  void check_conversion_on_access() {
+    const char* const definitions = "a = 1\n"
+                                    "large = 1, 99999999999\n"
+                                    "b = large\n";
+    collection lazy;
+    lazy.set_lazy_loading(true);
+    lazy.read_from_string(definitions);
+    CHECK(lazy.get_collection_size() == 2);
+    CHECK(lazy.get_value<int>("a") == 1);
+    CHECK_THROWS(lazy.get_value<int>("large"), "to an integer value");
+    CHECK_THROWS(lazy.get_value<int>("b"), "to an integer value");
+
+    CHECK_THROWS(collection().read_from_string(definitions), "");
+  }
+
+  /*
+   * The statements the scanner does not handle are read by the
+   * parser.
+   */
+  void check_fallback() {
+    collection c;
+    c.set_lazy_loading(true);
+    c.read_from_string("solver {\n"
+                       "  tol = 1e-8\n"
+                       "  maxit = 200\n"
+                       "}\n");
+    CHECK(c.get_value<double>("solver.tol") == 1e-8);
+    CHECK(c.get_value<int>("solver.maxit") == 200);
+  }
+
+  /*
+   * Threads accessing the same keys for the first time all read the
+   * converted values.
+   */
+  void check_concurrent_access() {
+    std::ostringstream text;
+    for (std::size_t i(0); i < 1000; ++i)
+      text << "key-" << i << " = " << i << "\n";
+    collection c;
+    c.set_lazy_loading(true);
+    c.read_from_string(text.str());
+
+    std::vector<std::thread> threads;
+    std::vector<std::size_t> errors(4, 0);
+    for (std::size_t k(0); k < 4; ++k)
+      threads.push_back(std::thread([&c, &errors, k]() {
+            for (std::size_t i(0); i < 1000; ++i)
+              errors[k] += c.get_basic_value("key-" + std::to_string(i))->print_value() != std::to_string(i);
+          }));
+    for (auto& t: threads)
+      t.join();
+    CHECK((errors == std::vector<std::size_t>(4, 0)));
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("lazy"));
+  try {
+    check_equality(directory);
+    check_conversion_on_access();
+    check_fallback();
+    check_concurrent_access();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,62 @@
+#include <fstream>
+
+// only the installed header, the definitions come from libparameter.a
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  enum class solver { cg, gmres };
+
+  /*
+   * Every value type compiled in the library, through the typed
+   * accessors and through the stored values.
+   */
+  void check_value_types(const std::string& directory) {
+    const std::string table(directory + "/mesh.csv");
+    std::ofstream(table) << "cells,width\n"
+                         << "10,0.5\n"
+                         << "20,0.25\n";
+
+    collection c;
+    c.read_from_string("n = 3\n"
+                       "verbose = on\n"
+                       "dt = 0.5\n"
+                       "name = \"run-{n}\"\n"
+                       "method = #gmres\n"
+                       "import #csv \"" + table + "\" -> mesh [ cells: #int  width: #real ]\n");
+
+    CHECK(c.get_value<int>("n") == 3);
+    CHECK(c.get_value<bool>("verbose"));
+    CHECK(c.get_value<double>("dt") == 0.5);
+    CHECK(c.get_value<std::string>("name") == "run-3");
+    CHECK(c.get_enum_value("method", std::map<std::string, solver>{{"cg", solver::cg},
+                                                                   {"gmres", solver::gmres}})
+          == solver::gmres);
+    CHECK_THROWS(c.get_value<double>("name"), "name");
+
+    const column_view<int> cells(c.get_column<int>("mesh-cells"));
+    const column_view<double> width(c.get_column<double>("mesh-width"));
+    CHECK(cells.size == 2 and cells.data[1] == 20);
+    CHECK(width.size == 2 and width.data[1] == 0.25);
+
+    const value<std::string>* name(dynamic_cast<const value<std::string>*>(c.get_basic_value("name")));
+    CHECK(name and name->get_type() == "string");
+    std::unique_ptr<basic_value> copy(name->clone());
+    CHECK(copy->print_value() == name->print_value());
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("library"));
+  try {
+    check_value_types(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,107 @@
+#include <algorithm>
+
+#include "../src/parameter.hpp"
+#include "../src/scope.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  typedef std::vector<std::string> keys;
+
+  const char* const solver_text =
+    "solver {\n"
+    "  linear { tol = 1e-8  maxit = 200, 400 }\n"
+    "  nonlinear.maxit = 20\n"
+    "  name = \"cg-{solver.linear.maxit}\"\n"
+    "}\n"
+    "solvers = 2\n"
+    "output.prefix = \"run\"\n";
+
+  void check_namespace_blocks() {
+    collection c;
+    c.read_from_string(solver_text);
+    CHECK(c.get_collection_size() == 2);
+    c.set_current_collection(1);
+    CHECK(c.get_value<double>("solver.linear.tol") == 1e-8);
+    CHECK(c.get_value<int>("solver.linear.maxit") == 400);
+    CHECK(c.get_value<int>("solver.nonlinear.maxit") == 20);
+    CHECK(c.get_value<std::string>("solver.name") == "cg-400");
+    CHECK(not c.contains("tol") and not c.contains("linear.tol"));
+
+    // keys are still stored under their full name
+    collection same;
+    same.read_from_string("solver.linear.tol = 1e-8\n"
+                          "solver.linear.maxit = 200, 400\n"
+                          "solver.nonlinear.maxit = 20\n"
+                          "solver.name = \"cg-{solver.linear.maxit}\"\n"
+                          "solvers = 2\n"
+                          "output.prefix = \"run\"\n");
+    CHECK(c.get_keys() == same.get_keys());
+
+    collection imported;
+    CHECK_THROWS(imported.read_from_string("solver { import \"other.conf\" }\n"), "import");
+  }
+
+  void check_key_queries() {
+    collection c;
+    c.read_from_string(solver_text);
+
+    // "solvers" shares the characters of the prefix but not the namespace
+    CHECK((c.get_keys_with_prefix("solver.")
+           == keys{"solver.linear.maxit", "solver.linear.tol",
+                   "solver.name", "solver.nonlinear.maxit"}));
+    CHECK((c.get_keys_with_prefix("solver.linear.")
+           == keys{"solver.linear.maxit", "solver.linear.tol"}));
+    CHECK(c.get_keys_with_prefix("missing.").empty());
+    CHECK(c.get_keys_with_prefix("") == c.get_keys());
+
+    CHECK((c.get_keys_matching("solver.*.maxit")
+           == keys{"solver.linear.maxit", "solver.nonlinear.maxit"}));
+    CHECK((c.get_keys_matching("*.prefix") == keys{"output.prefix"}));
+    CHECK((c.get_keys_matching("solver?") == keys{"solvers"}));
+    CHECK((c.get_keys_matching("solver.linear.to?") == keys{"solver.linear.tol"}));
+    CHECK(c.get_keys_matching("solver.linear").empty());
+    CHECK(c.get_keys_matching("*") == c.get_keys());
+  }
+
+  void check_scopes() {
+    collection c;
+    c.read_from_string(solver_text);
+    c.set_current_collection(1);
+
+    const collection_scope solver(c, "solver");
+    CHECK(solver.get_key("name") == "solver.name");
+    CHECK(solver.get_value<std::string>("name") == "cg-400");
+    CHECK(solver.get_value<int>("nonlinear.maxit") == 20);
+    CHECK(solver.get_value_or("nonlinear.tol", 1e-4) == 1e-4);
+    CHECK(solver.contains("linear.tol") and not solver.contains("solvers"));
+    CHECK((solver.get_keys()
+           == keys{"linear.maxit", "linear.tol", "name", "nonlinear.maxit"}));
+
+    // the scope reads the current point of the collection
+    const collection_scope linear(solver.get_scope("linear"));
+    CHECK(linear.get_prefix() == "solver.linear.");
+    CHECK(linear.get_value<int>("maxit") == 400);
+    c.set_current_collection(0);
+    CHECK(linear.get_value<int>("maxit") == 200);
+    CHECK_THROWS(linear.get_value<int>("maxiter"), "solver.linear.maxiter");
+
+    const collection_scope root(c, "");
+    CHECK(root.get_keys() == c.get_keys());
+  }
+
+}
+
+int main() {
+  try {
+    check_namespace_blocks();
+    check_key_queries();
+    check_scopes();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
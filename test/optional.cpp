@@ -0,0 +1,61 @@
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  /*
+   * Missing keys fall back silently, defined keys behave as with
+   * get_value.
+   */
+  void check_lookups() {
+    collection c;
+    c.read_from_string("n = 1, 2\n"
+                       "tolerance = 1e-6\n"
+                       "name = \"run-{n}\"\n"
+                       "verbose = true\n");
+    c.set_current_collection(1);
+
+    int n(0);
+    CHECK(c.try_get_value("n", n) and n == 2);
+    int missing(7);
+    CHECK(not c.try_get_value("m", missing) and missing == 7);
+
+    CHECK(c.get_value_or("tolerance", 1.0) == 1e-6);
+    CHECK(c.get_value_or("max_iterations", 100) == 100);
+    CHECK(c.get_value_or("verbose", false));
+    CHECK(c.get_value_or("name", "default") == "run-2");
+    CHECK(c.get_value_or("prefix", "default") == "default");
+
+    CHECK(c.contains("n") and c.contains("name"));
+    CHECK(not c.contains("nam") and not c.contains(""));
+  }
+
+  void check_errors() {
+    collection c;
+    c.read_from_string("tolerance = 1e-6\n"
+                       "name = \"run\"\n");
+
+    // a defined key of another type is still an error
+    int n(0);
+    CHECK_THROWS(c.try_get_value("name", n), "name");
+    CHECK_THROWS(c.get_value_or("tolerance", false), "tolerance");
+
+    // only the throwing lookup searches for a suggestion
+    CHECK_THROWS(c.get_value<double>("tolerence"), "did you mean 'tolerance'");
+    CHECK(c.get_value_or("tolerence", 0.5) == 0.5);
+  }
+
+}
+
+int main() {
+  try {
+    check_lookups();
+    check_errors();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
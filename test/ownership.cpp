@@ -0,0 +1,76 @@
+#include <type_traits>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  static_assert(not std::is_copy_constructible<collection::multi_value>::value,
+                "the values of a multi_value are only copied by clone");
+  static_assert(std::is_nothrow_move_constructible<collection::multi_value>::value,
+                "vectors of multi_values move their elements when they grow");
+
+  /*
+   * Moving a multi_value hands over its values, cloning it copies each
+   * of them.
+   */
+  void check_multi_value_ownership() {
+    const std::size_t value_number(1000);
+    collection::multi_value mv;
+    mv.values.reserve(value_number);
+    for (std::size_t i(0); i < value_number; ++i)
+      mv.append_value(new value<int>(int(i)));
+    basic_value* const* const values(mv.values.data());
+
+    collection::multi_value moved(std::move(mv));
+    CHECK(mv.get_value_number() == 0 and moved.get_value_number() == value_number);
+    CHECK(moved.values.data() == values);
+
+    const collection::multi_value copy(moved.clone());
+    CHECK(copy.get_value_number() == value_number);
+    std::size_t shared(0), different(0);
+    for (std::size_t i(0); i < value_number; ++i) {
+      if (copy.values[i] == moved.values[i])
+        shared += 1;
+      if (copy.values[i]->print_value() != moved.values[i]->print_value())
+        different += 1;
+    }
+    CHECK(shared == 0 and different == 0);
+  }
+
+  /*
+   * A copied collection owns its values: changing the original leaves
+   * the copy as it was.
+   */
+  void check_collection_copies() {
+    collection c;
+    c.read_from_string("n = 1, 2\n"
+                       "name = \"run-{n}\"\n");
+    const collection copy(c);
+    collection assigned;
+    assigned = c;
+
+    c.append_key_value("n", 3);
+    c.read_from_string("override name = \"out-{n}\"\n");
+    CHECK(c.get_collection_size() == 3);
+    for (const collection* x: {&copy, static_cast<const collection*>(&assigned)}) {
+      CHECK(x->get_collection_size() == 2);
+      CHECK(x->get_multi_value("n").get_value_number() == 2);
+      CHECK(x->get_value<std::string>("name") == "run-1");
+    }
+  }
+
+}
+
+int main() {
+  try {
+    check_multi_value_ownership();
+    check_collection_copies();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,97 @@
+#include <fstream>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+  }
+
+  /*
+   * The keys of a point table share one dimension, which takes as many
+   * values as the table has rows.
+   */
+  void check_point_tables() {
+    collection c;
+    c.read_from_string("(solver, tolerance, iterations) = (#cg, 1e-8, 200),\n"
+                       "                                  (#gmres, 1e-6, 50),\n"
+                       "                                  (#gmres, 1e-4, 20)\n"
+                       "n = 1, 2\n");
+    CHECK(c.get_collection_size() == 6);
+    CHECK(c.get_multi_value("solver").get_index_id() == c.get_multi_value("iterations").get_index_id());
+
+    std::size_t cg(0);
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      const int iterations(c.get_value<int>("iterations"));
+      CHECK(iterations == 200 or iterations == 50 or iterations == 20);
+      if (c.get_enum_token("solver") == "cg") {
+        cg += 1;
+        CHECK(iterations == 200 and c.get_value<double>("tolerance") == 1e-8);
+      } else {
+        CHECK(iterations != 200 and c.get_value<double>("tolerance") != 1e-8);
+      }
+    }
+    CHECK(cg == 2);
+
+    c.read_from_string("override (solver, tolerance, iterations) = (#cg, 1e-10, 500)\n");
+    CHECK(c.get_collection_size() == 2);
+    CHECK(c.get_value<int>("iterations") == 500);
+  }
+
+  void check_errors() {
+    CHECK_THROWS(collection().read_from_string("(a, b) = (1, 2), (3)\n"), "has 1 values instead of 2");
+    CHECK_THROWS(collection().read_from_string("(a, b) = (1, 2, 3)\n"), "has more values than the 2 keys");
+    CHECK_THROWS(collection().read_from_string("(a, a) = (1, 2)\n"), "the key 'a' is repeated");
+
+    collection::multi_value mv;
+    CHECK_THROWS(mv.get_value(collection::multi_index()), "no value");
+  }
+
+  /*
+   * Each row of the table is a point of the keys named after its
+   * columns. A table without rows would leave the keys without values.
+   */
+  void check_imports(const std::string& directory) {
+    write_file(directory + "/design.csv",
+               "reynolds,resolution\n"
+               "100,16\n"
+               "1000,32\n"
+               "10000,64\n");
+    write_file(directory + "/design.conf", "import #csv \"design.csv\" -> (reynolds, resolution)\n");
+
+    collection c;
+    c.read_from_file(directory + "/design.conf");
+    CHECK(c.get_collection_size() == 3);
+    c.set_current_collection(2);
+    CHECK(c.get_value<int>("reynolds") == 10000);
+    CHECK(c.get_value<int>("resolution") == 64);
+
+    write_file(directory + "/empty.csv", "x,y\n");
+    write_file(directory + "/empty.conf", "import #csv \"empty.csv\" -> (x, y)\n");
+    collection empty;
+    CHECK_THROWS(empty.read_from_file(directory + "/empty.conf"), "has no rows");
+    CHECK(not empty.contains("x"));
+
+    write_file(directory + "/missing.conf", "import #csv \"design.csv\" -> (reynolds, mach)\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/missing.conf"), "no column named 'mach'");
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("points"));
+  try {
+    check_point_tables();
+    check_errors();
+    check_imports(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,104 @@
+#include "../src/parameter.hpp"
+#include "../src/prefetch.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  const char* const sweep_definitions =
+    "n = 1, 2, 3\n"
+    "k = 4, 5\n"
+    "dt = 0.1, 0.2\n"
+    "name = \"run-{n}-{k}\"\n"
+    "alias = name\n"
+    "alias2 = alias\n"
+    "path = \"{alias2}/{dt}\"\n"
+    "r = n\n"
+    "rr = r\n"
+    "solver = #cg, #gmres\n"
+    "method = solver\n";
+
+  std::string print(const basic_value* v) {
+    const std::string s(v->print_value());
+    delete v;
+    return s;
+  }
+
+  /*
+   * get_value, get_resolved_value and the prefetching sweep give the
+   * same value of every key at every point.
+   */
+  void check_serial_equality() {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    const std::vector<std::string> keys(c.get_keys());
+    const std::size_t point_number(c.get_collection_size());
+
+    prefetching_sweep sweep(c, 3);
+    CHECK(sweep.get_point_number() == point_number);
+    for (std::size_t i(0); i < point_number; ++i) {
+      CHECK(sweep.next());
+      CHECK(sweep.get_index() == i);
+      c.set_current_collection(i);
+
+      for (const auto& key: keys) {
+        const std::string evaluated(print(c.get_basic_value(key)->eval(c)));
+        CHECK(evaluated == print(c.get_resolved_value(key)));
+        CHECK(evaluated == sweep.get_basic_value(key)->print_value());
+      }
+
+      CHECK(c.get_value<std::string>("alias") == c.get_value<std::string>("name"));
+      // an interpolated string is printed with its quotes
+      CHECK(c.get_value<std::string>("path").find("\"" + c.get_value<std::string>("name") + "\"/0.")
+            == 0);
+      CHECK(c.get_value<int>("rr") == c.get_value<int>("n"));
+      CHECK(c.get_enum_token("method") == c.get_enum_token("solver"));
+      CHECK(sweep.get_value<std::string>("alias2") == c.get_value<std::string>("name"));
+      CHECK(sweep.get_enum_token("method") == c.get_enum_token("solver"));
+    }
+    CHECK(not sweep.next());
+
+    c.set_current_collection(4);
+    CHECK(c.get_value<std::string>("alias2") == "run-2-5");
+  }
+
+  void check_errors() {
+    collection c;
+    c.read_from_string("a = \"{b}\"\n"
+                       "b = a\n"
+                       "self = \"{self}\"\n"
+                       "x = y\n"
+                       "y = x\n"
+                       "dt = 0.1, 0.2\n"
+                       "n = 3\n");
+    CHECK_THROWS(c.get_value<std::string>("a"), "circular reference");
+    CHECK_THROWS(c.get_value<std::string>("self"), "circular reference");
+    CHECK_THROWS(c.get_value<int>("x"), "circular reference");
+    CHECK_THROWS(c.get_value<int>("dt"), "which has type real");
+
+    prefetching_sweep sweep(c, std::vector<std::string>{"n", "dt"});
+    CHECK_THROWS(sweep.get_basic_value("n"), "no current point");
+    CHECK(sweep.next());
+    CHECK_THROWS(sweep.get_value<int>("dt"), "which has type real");
+    CHECK_THROWS(sweep.get_basic_value("x"), "not resolved by the prefetching sweep");
+
+    // an error resolving a point is thrown by next
+    prefetching_sweep undefined(c, std::vector<std::string>{"n", "undefined"});
+    CHECK_THROWS(undefined.next(), "not found");
+    prefetching_sweep circular(c, std::vector<std::string>{"x"});
+    CHECK_THROWS(circular.next(), "circular reference");
+  }
+
+}
+
+int main() {
+  try {
+    check_serial_equality();
+    check_errors();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
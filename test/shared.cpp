@@ -0,0 +1,188 @@
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include <signal.h>
+#include <sys/wait.h>
+
+#include "../src/parameter.hpp"
+#include "../src/shared.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  const char* const definitions =
+    "n = 1, 2, 3\n"
+    "dt = 0.1, 0.2\n"
+    "name = \"run-{n}\"\n"
+    "alias = name\n"
+    "r = n\n"
+    "solver = #cg, #gmres\n"
+    "flag = true\n";
+
+  std::string print_points(collection& c) {
+    std::ostringstream stream;
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      c.print_key_values(stream);
+      stream << c.get_value<std::string>("alias") << " " << c.get_value<int>("r") << " "
+             << c.get_enum_token("solver") << std::endl;
+    }
+    return stream.str();
+  }
+
+  /*
+   * Processes reading the same file through read_shared see the
+   * collection a serial read gives, and attached processes read and
+   * list the keys without copying them out of the segment.
+   */
+  void check_forked_readers(const std::string& filename, const std::string& segment) {
+    collection reference;
+    reference.read_from_file(filename);
+    const std::string expected(print_points(reference));
+    const std::vector<std::string> keys(reference.get_keys());
+
+    const std::size_t process_number(4);
+    for (std::size_t p(0); p < process_number; ++p)
+      if (fork() == 0) {
+        int status(0);
+        try {
+          collection c;
+          c.read_shared(filename, segment);
+          if (print_points(c) != expected)
+            status |= 1;
+          if (c.get_keys() != keys or c.get_keys_with_prefix("d") != std::vector<std::string>{"dt"})
+            status |= 2;
+          std::vector<diagnostic> d;
+          c.check_references(d);
+          if (d.size() or not c.contains("flag") or c.contains("flags"))
+            status |= 4;
+          if (c.is_shared() and c.get_memory_usage().by_key.size())
+            status |= 8;
+        } catch (const std::string& e) {
+          std::cerr << e << std::endl;
+          status |= 16;
+        }
+        _exit(status);
+      }
+
+    int status(0);
+    for (std::size_t p(0); p < process_number; ++p) {
+      wait(&status);
+      CHECK(WIFEXITED(status) and WEXITSTATUS(status) == 0);
+    }
+
+    // the segment stays published for the later readers
+    collection c;
+    c.read_shared(filename, segment);
+    CHECK(c.is_shared());
+    CHECK(print_points(c) == expected);
+
+    // redefinitions are local to the process
+    c.read_from_string("override dt = 0.5\n");
+    CHECK(c.get_collection_size() == reference.get_collection_size() / 2);
+    CHECK(c.get_value<double>("dt") == 0.5);
+  }
+
+  /*
+   * Threads reading different keys of an attached collection, through
+   * the accessors returning references, see the serial values.
+   */
+  void check_concurrent_readers(const std::string& filename, const std::string& segment) {
+    collection reference;
+    reference.read_from_file(filename);
+    const std::vector<std::string> keys(reference.get_keys());
+    std::vector<std::string> expected;
+    for (const auto& key: keys)
+      expected.push_back(reference.get_basic_value(key)->print_value());
+    std::vector<int> n(reference.get_collection_size());
+    reference.evaluate_column("r", 0, n.size(), n.data());
+
+    collection c;
+    c.read_shared(filename, segment);
+    CHECK(c.is_shared());
+
+    std::vector<int> same(4, 1);
+    std::vector<std::thread> threads;
+    for (std::size_t t(0); t < same.size(); ++t)
+      threads.emplace_back([&, t]() {
+          for (std::size_t i(0); i < keys.size(); ++i) {
+            // each thread starts at another key
+            const std::size_t j((i + t) % keys.size());
+            if (c.get_basic_value(keys[j])->print_value() != expected[j]
+                or c.get_multi_value(keys[j]).get_value_number()
+                != reference.get_multi_value(keys[j]).get_value_number())
+              same[t] = 0;
+          }
+          std::vector<int> column(n.size());
+          c.evaluate_column("r", 0, column.size(), column.data());
+          if (column != n)
+            same[t] = 0;
+        });
+    for (auto& t: threads)
+      t.join();
+
+    for (const auto s: same)
+      CHECK(s);
+  }
+
+  void check_modified_source(const std::string& filename, const std::string& segment) {
+    // the time of modification is only compared to the nanosecond on
+    // file systems which record it, the size changes in any case
+    std::ofstream(filename, std::ios::app) << "extra = 1\n";
+
+    collection c;
+    CHECK_THROWS(c.read_shared(filename, segment), "in its current state");
+    CHECK(not c.is_shared());
+
+    collection::unlink_shared(segment);
+    c.read_shared(filename, segment);
+    CHECK(c.get_value<int>("extra") == 1);
+  }
+
+  void check_dead_creator(const std::string& segment) {
+    collection::unlink_shared(segment);
+
+    const pid_t creator(fork());
+    if (creator == 0) {
+      std::unique_ptr<shared_segment> s(shared_segment::create(segment));
+      pause();
+      _exit(0);
+    }
+
+    // the creator is killed while it is loading
+    usleep(100000);
+    kill(creator, SIGKILL);
+    waitpid(creator, nullptr, 0);
+
+    collection c;
+    CHECK_THROWS(c.attach_shared(segment), "exited before publishing");
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("shared"));
+  const std::string filename(directory + "/sweep.conf");
+  std::ofstream(filename) << definitions;
+  const std::string segment("/parameter-test-" + std::to_string(getpid()));
+
+  try {
+    collection::unlink_shared(segment);
+    check_forked_readers(filename, segment);
+    check_concurrent_readers(filename, segment);
+    check_modified_source(filename, segment);
+    check_dead_creator(segment);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+
+  collection::unlink_shared(segment);
+  std::remove(filename.c_str());
+  rmdir(directory.c_str());
+  return parameter_test::failures();
+}
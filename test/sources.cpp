@@ -0,0 +1,79 @@
+#include <sstream>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  bool contains_message(const std::vector<diagnostic>& d, const std::string& text) {
+    for (const auto& x: d)
+      if (x.message.find(text) != std::string::npos)
+        return true;
+    return false;
+  }
+
+  /*
+   * Strings and streams follow the grammar and the redefinition rules
+   * of files.
+   */
+  void check_in_memory_sources() {
+    collection c;
+    c.read_from_string("n = 1, 2, 3\n"
+                       "name = \"run-{n}\"\n");
+    std::istringstream stream("override n = 4, 5\n"
+                              "dt = 0.5\n");
+    c.read_from_stream(stream);
+    CHECK(c.get_collection_size() == 2);
+    c.set_current_collection(1);
+    CHECK(c.get_value<std::string>("name") == "run-5");
+    CHECK(c.get_value<double>("dt") == 0.5);
+
+    std::vector<diagnostic> sink;
+    c.set_diagnostic_sink(&sink);
+    c.read_from_string("dt = 1.0\n", "defaults");
+    CHECK(sink.size() == 1 and not sink.front().is_error());
+    CHECK(contains_message(sink, "defaults:1"));
+
+    c.set_diagnostic_sink(nullptr);
+    CHECK_THROWS(c.read_from_string("m = \n", "broken"), "broken");
+  }
+
+  void check_overrides() {
+    collection c;
+    c.read_from_string("n = 1\n"
+                       "solver = #cg\n"
+                       "prefix = \"run\"\n");
+
+    const char* const argv[] = {"program", "input.dat", "--n=2, 3", "--override", "solver=#gmres",
+                                "--override=prefix=\"out\"", "-v", "--verbose", "--m=true"};
+    std::vector<diagnostic> sink;
+    c.set_diagnostic_sink(&sink);
+    const std::vector<std::string> remaining(c.apply_overrides(9, argv));
+    CHECK((remaining == std::vector<std::string>{"input.dat", "-v", "--verbose"}));
+
+    // only the plain redefinition of n warns
+    CHECK(sink.size() == 1 and contains_message(sink, "argv[2]"));
+    CHECK(c.get_collection_size() == 2);
+    CHECK(c.get_enum_token("solver") == "gmres");
+    CHECK(c.get_value<std::string>("prefix") == "out");
+    CHECK(c.get_value<bool>("m"));
+
+    c.set_diagnostic_sink(nullptr);
+    const char* const bad[] = {"program", "--override", "n=+"};
+    CHECK_THROWS(c.apply_overrides(3, bad), "argv[2]");
+  }
+
+}
+
+int main() {
+  try {
+    check_in_memory_sources();
+    check_overrides();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <fstream>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  void write_file(const std::string& path, const std::string& text) {
+    std::ofstream(path) << text;
+  }
+
+  /*
+   * Real columns first, then integer columns, as the table is mapped.
+   */
+  void write_binary_table(const std::string& path, const std::vector<double>& x,
+                          const std::vector<std::int32_t>& id) {
+    std::ofstream stream(path, std::ios::binary);
+    stream.write(reinterpret_cast<const char*>(x.data()), x.size() * sizeof(double));
+    stream.write(reinterpret_cast<const char*>(id.data()), id.size() * sizeof(std::int32_t));
+  }
+
+  void check_binary_table(const std::string& directory) {
+    const std::vector<double> x = {0., 0.25, -1.5, 1e300};
+    const std::vector<std::int32_t> id = {7, -2, 2147483647, 0};
+    write_binary_table(directory + "/mesh.bin", x, id);
+    write_file(directory + "/binary.conf",
+               "import #binary \"mesh.bin\" -> mesh [ x: #real  id: #integer ]\n"
+               "[ a = 1, 2\n"
+               "  b = 3, 4 ]\n");
+
+    collection c;
+    c.read_from_file(directory + "/binary.conf");
+    const column_view<double> mesh_x(c.get_column<double>("mesh-x"));
+    const column_view<int> mesh_id(c.get_column<int>("mesh-id"));
+    CHECK((std::vector<double>(mesh_x.begin(), mesh_x.end()) == x));
+    CHECK((std::vector<int>(mesh_id.begin(), mesh_id.end()) == std::vector<int>(id.begin(), id.end())));
+    CHECK_THROWS(c.get_column<double>("mesh-id"), "failed to get a real-column");
+
+    // the group after the import is read as a group
+    CHECK(c.get_collection_size() == 2);
+    c.set_current_collection(1);
+    CHECK(c.get_value<int>("b") == 4);
+
+    // a copy of the collection shares the mapping
+    const collection copy(c);
+    CHECK(copy.get_column<double>("mesh-x").data == mesh_x.data);
+
+    // 3 rows: the real column would start at byte 12
+    write_binary_table(directory + "/odd.bin", {1., 2., 3.}, {1, 2, 3});
+    write_file(directory + "/misaligned.conf", "import #binary \"odd.bin\" -> odd [ id: #integer  x: #real ]\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/misaligned.conf"), "declare the real columns first");
+    write_file(directory + "/row-size.conf", "import #binary \"mesh.bin\" -> mesh [ x: #real  y: #real  id: #integer ]\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/row-size.conf"), "multiple of the declared row size");
+  }
+
+  void check_csv_table(const std::string& directory) {
+    write_file(directory + "/inflow.csv",
+               "t, velocity ,count\n"
+               "0, 1.5, 3\n"
+               "1, -2, 4\n"
+               "2, 1e-3, 5\n");
+    write_file(directory + "/csv.conf", "import #csv \"inflow.csv\" -> inflow\n");
+
+    collection c;
+    c.read_from_file(directory + "/csv.conf");
+    const column_view<int> t(c.get_column<int>("inflow-t"));
+    const column_view<double> velocity(c.get_column<double>("inflow-velocity"));
+    CHECK((std::vector<int>(t.begin(), t.end()) == std::vector<int>{0, 1, 2}));
+    CHECK((std::vector<double>(velocity.begin(), velocity.end()) == std::vector<double>{1.5, -2., 1e-3}));
+    CHECK(c.get_column<int>("inflow-count")[2] == 5);
+
+    // a declaration selects the columns and their types
+    write_file(directory + "/declared.conf", "import #csv \"inflow.csv\" -> inflow [ count: #real ]\n");
+    collection d;
+    d.read_from_file(directory + "/declared.conf");
+    CHECK(d.get_column<double>("inflow-count")[0] == 3.);
+    CHECK(not d.contains("inflow-t"));
+
+    write_file(directory + "/large.csv", "n\n1\n2147483648\n");
+    write_file(directory + "/large.conf", "import #csv \"large.csv\" -> t [ n: #integer ]\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/large.conf"), "out of the int32 range");
+
+    write_file(directory + "/broken.csv", "a,b\n1,2\n3,x\n");
+    write_file(directory + "/broken.conf", "import #csv \"broken.csv\" -> t\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/broken.conf"), "at line 3");
+
+    write_file(directory + "/missing.conf", "import #csv \"inflow.csv\" -> t [ pressure: #real ]\n");
+    CHECK_THROWS(collection().read_from_file(directory + "/missing.conf"), "no column named 'pressure'");
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("tables"));
+  try {
+    check_binary_table(directory);
+    check_csv_table(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,106 @@
+#include <sstream>
+#include <thread>
+
+#include "../src/tracing.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  std::size_t count_occurrences(const std::string& text, const std::string& pattern) {
+    std::size_t n(0);
+    for (std::size_t i(text.find(pattern)); i != std::string::npos; i = text.find(pattern, i + 1))
+      n += 1;
+    return n;
+  }
+
+  /*
+   * Each thread records into its own buffer, every point ends up in
+   * the trace with the values of the traced keys.
+   */
+  void check_threads() {
+    collection c;
+    c.read_from_string("n = 1, 2, 3\n"
+                       "dt = 0.5, 0.25\n"
+                       "name = \"run-{n}\"\n");
+
+    sweep_tracer tracer({"n", "name"});
+    std::vector<std::thread> threads;
+    for (std::size_t k(0); k < 4; ++k)
+      threads.push_back(std::thread([&c, &tracer, k]() {
+            for (std::size_t i(k); i < c.get_collection_size(); i += 4)
+              sweep_tracer::scope s(tracer, i);
+          }));
+    for (auto& t: threads)
+      t.join();
+
+    CHECK(tracer.get_thread_number() == 4);
+    CHECK(tracer.get_event_number() == 6);
+
+    std::ostringstream stream;
+    tracer.write_chrome_trace(c, stream);
+    const std::string trace(stream.str());
+    CHECK(trace.compare(0, 15, "{\"displayTimeUn") == 0);
+    CHECK(trace.compare(trace.size() - 4, 4, "\n]}\n") == 0);
+    CHECK(count_occurrences(trace, "\"ph\":\"X\"") == 6);
+    CHECK(count_occurrences(trace, "\"name\":\"run-2\"") == 2);
+    CHECK(count_occurrences(trace, "\"tid\":3") == 1);
+    CHECK(trace.find("{\"name\":\"point 5\"") != std::string::npos);
+    CHECK(trace.find("\"args\":{\"index\":5,\"n\":") != std::string::npos);
+  }
+
+  /*
+   * The summary gives the mean time of each value of each dimension,
+   * relative to the cheapest one.
+   */
+  void check_summary() {
+    collection c;
+    c.read_from_string("n = 1, 2\n"
+                       "dt = 0.5, 0.25, 0.125\n");
+
+    sweep_tracer tracer;
+    const sweep_tracer::clock::time_point start(sweep_tracer::clock::now());
+    for (std::size_t i(0); i < c.get_collection_size(); ++i) {
+      c.set_current_collection(i);
+      const int n(c.get_value<int>("n"));
+      tracer.record(i, start, start + std::chrono::milliseconds(n));
+    }
+
+    std::ostringstream stream;
+    tracer.write_summary(c, stream);
+    const std::string summary(stream.str());
+    CHECK(summary.find("dimension n:") != std::string::npos);
+    CHECK(summary.find("dimension dt:") != std::string::npos);
+    CHECK(count_occurrences(summary, "3 points, mean         1000 us, 1x") == 1);
+    CHECK(count_occurrences(summary, "3 points, mean         2000 us, 2x") == 1);
+    CHECK(count_occurrences(summary, "2 points, mean         1500 us, 1x") == 3);
+  }
+
+  /*
+   * A thread recording into two tracers keeps their events apart.
+   */
+  void check_tracers() {
+    sweep_tracer first, second;
+    for (std::size_t i(0); i < 3; ++i) {
+      sweep_tracer::scope s(first, i);
+      sweep_tracer::scope t(second, i);
+    }
+    { sweep_tracer::scope s(first, 3); }
+    CHECK(first.get_event_number() == 4 and first.get_thread_number() == 1);
+    CHECK(second.get_event_number() == 3 and second.get_thread_number() == 1);
+  }
+
+}
+
+int main() {
+  try {
+    check_threads();
+    check_summary();
+    check_tracers();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}
@@ -0,0 +1,133 @@
+#include <cstdio>
+#include <fstream>
+
+#include "../src/parameter.hpp"
+#include "../src/validation.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  std::size_t count(const std::vector<diagnostic>& d, const std::string& text) {
+    std::size_t n(0);
+    for (const auto& x: d)
+      n += x.is_error() and x.message.find(text) != std::string::npos;
+    return n;
+  }
+
+  // a character no token starts with, on the second line
+  const char* const lexical_error_definitions = "a = 1\nb = 2 $ c\nd = 3\n";
+
+  /*
+   * An error of the lexer ends the parse of the file with one
+   * diagnostic, the statements before it being kept.
+   */
+  void check_lexical_error(const std::string& directory) {
+    std::vector<diagnostic> d;
+    validator().validate_file(directory + "/lexical.conf", d);
+    CHECK(d.size() == 1 and count(d, "is not read") == 1);
+
+    collection c;
+    std::vector<diagnostic> sink;
+    c.set_diagnostic_sink(&sink);
+    c.read_from_string(lexical_error_definitions);
+    CHECK(sink.size() == 1);
+    CHECK(c.get_value<int>("a") == 1);
+    CHECK(not c.contains("d"));
+
+    // without a sink the error is thrown
+    collection thrown;
+    CHECK_THROWS(thrown.read_from_string(lexical_error_definitions), "is not read");
+
+    // nor does an import stop on it
+    collection importing;
+    std::vector<diagnostic> import_sink;
+    importing.set_diagnostic_sink(&import_sink);
+    importing.read_from_string("import \"" + directory + "/lexical.conf\"\nafter = 1\n");
+    CHECK(import_sink.size() == 1 and importing.get_value<int>("after") == 1);
+  }
+
+  /*
+   * A parse error is reported, and the parse resumes at the next
+   * statement, so that every error of a file is reported at once.
+   */
+  void check_recovery() {
+    collection c;
+    std::vector<diagnostic> d;
+    c.set_diagnostic_sink(&d);
+    c.read_from_string("a = 1\n"
+                       "b = = 2\n"
+                       "c = 3\n"
+                       "[ d = 1, 2\n"
+                       "  e = 3 4 ]\n"
+                       "f = 2\n"
+                       "g = 1 2\n");
+    CHECK(d.size() == 3);
+    CHECK(count(d, "unexpected <equal> token at <string>:2:5") == 1);
+    CHECK(c.get_value<int>("c") == 3 and c.get_value<int>("f") == 2);
+    CHECK(not c.contains("b") and not c.contains("d"));
+  }
+
+  void check_schema(const std::string& directory) {
+    schema s;
+    s.read_from_file(directory + "/schema.conf");
+
+    validator v;
+    v.set_schema(&s);
+    v.set_thread_number(4);
+
+    std::vector<std::string> filenames;
+    for (std::size_t i(0); i < 16; ++i) {
+      filenames.push_back(directory + "/valid.conf");
+      filenames.push_back(directory + "/invalid.conf");
+      filenames.push_back(directory + "/lexical.conf");
+    }
+    filenames.push_back(directory + "/missing.conf");
+
+    const std::vector<file_report> reports(v.validate(filenames));
+    CHECK(reports.size() == filenames.size());
+    for (std::size_t i(0); i + 1 < reports.size(); i += 3) {
+      CHECK(reports[i].filename == filenames[i]);
+      CHECK(reports[i].diagnostics.empty());
+
+      const std::vector<diagnostic>& d(reports[i + 1].diagnostics);
+      CHECK(reports[i + 1].get_error_number() == 5 and reports[i + 1].get_warning_number() == 0);
+      CHECK(count(d, "the key 'a' should be of type integer but has a value 1.5 of type real") == 1);
+      CHECK(count(d, "the key 'f' refers to the undefined key 'g'") == 1);
+      CHECK(count(d, "the required key 'req' is not defined") == 1);
+      CHECK(count(d, "the key 'h' is not declared in the schema") == 1);
+      CHECK(count(d, "the value 'cg' of the key 'i' is not among the enum value set") == 1);
+
+      CHECK(count(reports[i + 2].diagnostics, "is not read") == 1);
+    }
+    CHECK(count(reports.back().diagnostics, "is not accessible") == 1);
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("validation"));
+  const std::vector<std::pair<std::string, std::string> > files{
+    {"lexical.conf", lexical_error_definitions},
+    {"schema.conf", "a = #integer\nf = #integer, #optional\ni = #enum, #gmres\nreq = #real\n"},
+    {"valid.conf", "a = 1, 2\nf = a\ni = #gmres\nreq = 0.5\n"},
+    {"invalid.conf", "a = 1.5\nf = g\nh = 1\ni = #cg\n"}
+  };
+  for (const auto& f: files)
+    std::ofstream(directory + "/" + f.first) << f.second;
+
+  try {
+    check_lexical_error(directory);
+    check_recovery();
+    check_schema(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+
+  for (const auto& f: files)
+    std::remove((directory + "/" + f.first).c_str());
+  rmdir(directory.c_str());
+  return parameter_test::failures();
+}
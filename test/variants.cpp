@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <fstream>
+
+#include "../src/parameter.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  std::size_t count(const std::vector<diagnostic>& d, bool is_error, const std::string& text) {
+    std::size_t n(0);
+    for (const auto& x: d)
+      n += x.is_error() == is_error and x.message.find(text) != std::string::npos;
+    return n;
+  }
+
+  /*
+   * The definitions of a variant follow the override rules of a normal
+   * import, the keys defined before the import counting as defined.
+   */
+  void check_override_rules(const std::string& directory, bool parallel_imports) {
+    collection c;
+    std::vector<diagnostic> d;
+    c.set_diagnostic_sink(&d);
+    c.set_parallel_imports(parallel_imports);
+    c.read_from_file(directory + "/rules.conf");
+
+    CHECK(count(d, true, "") == 0);
+    CHECK(count(d, false, "") == 1);
+    CHECK(count(d, false, "redefinition of key 'm'") == 1);
+
+    CHECK(c.get_collection_size() == 3);
+    for (std::size_t i(0); i < 3; ++i) {
+      c.set_current_collection(i);
+      CHECK(c.get_value<int>("n") == (i == 0 ? 30 : (i == 1 ? 40 : 10)));
+      CHECK(c.get_value<int>("m") == 2);
+      CHECK(c.get_value<int>("k") == int(i));
+    }
+  }
+
+  void check_undefined_override(const std::string& directory) {
+    collection c;
+    std::vector<diagnostic> d;
+    c.set_diagnostic_sink(&d);
+    c.read_from_file(directory + "/undefined.conf");
+    CHECK(count(d, true, "attempt to redefine key 'q'") == 1);
+  }
+
+  void check_normal_import(const std::string& directory) {
+    collection c;
+    std::vector<diagnostic> d;
+    c.set_diagnostic_sink(&d);
+    c.read_from_file(directory + "/plain.conf");
+    CHECK(count(d, true, "attempt to redefine key 'q'") == 1);
+    CHECK(count(d, false, "redefinition of key 'm'") == 1);
+  }
+
+  void check_errors(const std::string& directory) {
+    CHECK_THROWS(collection().read_from_file(directory + "/nested.conf"), "variants cannot be nested");
+    CHECK_THROWS(collection().read_from_file(directory + "/swept.conf"),
+                 "sweeps the key 'k', a variant can only give single values");
+    CHECK_THROWS(collection().read_from_file(directory + "/partial.conf"),
+                 "the key 'k' is defined by a variant imported at");
+    CHECK_THROWS(collection().read_from_file(directory + "/base.conf"),
+                 "the key 'k' is swept before the variants imported at");
+  }
+
+}
+
+int main() {
+  const std::string directory(parameter_test::make_directory("variants"));
+  const std::vector<std::pair<std::string, std::string> > files{
+    {"rules.conf", "n = 10\nm = 1\nimport \"a.conf\", \"b.conf\", \"c.conf\"\n"},
+    {"undefined.conf", "n = 10\nimport \"a.conf\", \"d.conf\"\n"},
+    {"plain.conf", "n = 10\nm = 1\nimport \"d.conf\"\nimport \"c.conf\"\n"},
+    // overriding a key defined before the import
+    {"a.conf", "override n = 30\noverride m = 2\nk = 0\n"},
+    {"b.conf", "override n = 40\noverride m = 2\nk = 1\n"},
+    // redefining without override
+    {"c.conf", "m = 2\nk = 2\n"},
+    // overriding an undefined key
+    {"d.conf", "override q = 1\n"},
+    // importing variants
+    {"nested.conf", "n = 10\nm = 1\nimport \"a.conf\", \"e.conf\"\n"},
+    {"e.conf", "import \"a.conf\", \"b.conf\"\n"},
+    {"swept.conf", "n = 10\nm = 1\nimport \"a.conf\", \"f.conf\"\n"},
+    // sweeping a key
+    {"f.conf", "k = 1, 2\n"},
+    // leaving k undefined
+    {"partial.conf", "n = 10\nm = 1\nimport \"a.conf\", \"g.conf\"\n"},
+    {"base.conf", "n = 10\nk = 1, 2\nimport \"h.conf\", \"g.conf\"\n"},
+    {"g.conf", "override n = 50\n"},
+    {"h.conf", "override k = 0\n"}
+  };
+  for (const auto& f: files)
+    std::ofstream(directory + "/" + f.first) << f.second;
+
+  try {
+    check_override_rules(directory, false);
+    check_override_rules(directory, true);
+    check_undefined_override(directory);
+    check_normal_import(directory);
+    check_errors(directory);
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+
+  for (const auto& f: files)
+    std::remove((directory + "/" + f.first).c_str());
+  rmdir(directory.c_str());
+  return parameter_test::failures();
+}
@@ -0,0 +1,80 @@
+#include "../src/parameter.hpp"
+#include "../src/view.hpp"
+
+#include "check.hpp"
+
+using namespace parameter;
+
+namespace {
+
+  const char* const sweep_definitions =
+    "n = 1, 2, 3\n"
+    "k = 4, 5\n"
+    "dt = 0.1, 0.2, 0.4\n"
+    "name = \"run-{n}-{k}\"\n"
+    "steps = 10\n";
+
+  /*
+   * The points of a view are the points of the collection selecting
+   * the kept values, in the order of the collection.
+   */
+  void check_point_order() {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    const collection_view all(c);
+    CHECK(all.get_collection_size() == c.get_collection_size());
+    for (std::size_t i(0); i < all.get_collection_size(); ++i)
+      CHECK(all.get_collection_index(i) == i);
+
+    const collection_view slice(all.fix("k", 5).restrict("dt", std::vector<std::size_t>{2, 0}));
+    CHECK(slice.get_collection_size() == 6);
+    std::size_t previous(0);
+    for (std::size_t i(0); i < slice.get_collection_size(); ++i) {
+      const std::size_t index(slice.get_collection_index(i));
+      CHECK(i == 0 or index > previous);
+      previous = index;
+
+      slice.set_current_collection(i);
+      CHECK(c.get_value<int>("k") == 5);
+      CHECK(c.get_value<double>("dt") != 0.2);
+      c.set_current_collection(index);
+      CHECK(c.get_current_point() == slice.get_point(i));
+    }
+
+    // a view of a view restricts it further
+    const collection_view run(slice.fix("n", 2).fix("dt", 0.4));
+    CHECK(run.get_collection_size() == 1);
+    run.set_current_collection(0);
+    CHECK(c.get_value<std::string>("name") == "run-2-5" and c.get_value<double>("dt") == 0.4);
+
+    // single valued keys keep every point
+    CHECK(all.fix("steps", 10).get_collection_size() == all.get_collection_size());
+    CHECK(all.restrict("steps", std::vector<std::size_t>{}).get_collection_size() == 0);
+    CHECK(all.restrict("n", std::vector<std::size_t>{}).get_collection_size() == 0);
+  }
+
+  void check_errors() {
+    collection c;
+    c.read_from_string(sweep_definitions);
+    const collection_view all(c);
+    CHECK_THROWS(all.fix("n", 4), "never takes the value 4");
+    CHECK_THROWS(all.fix("dt", 1), "never takes the value 1");
+    CHECK_THROWS(all.restrict("k", std::vector<std::size_t>{2}), "value id 2 out of the 2 values");
+    CHECK_THROWS(all.get_point(all.get_collection_size()), "point 18 out of the 18 points");
+    CHECK_THROWS(all.fix("undefined", 1), "undefined");
+
+    c.append_key_value("steps", 20);
+    CHECK_THROWS(all.get_point(0), "dimensions of the collection changed");
+  }
+
+}
+
+int main() {
+  try {
+    check_point_order();
+    check_errors();
+  } catch (const std::string& e) {
+    parameter_test::fail(__FILE__, __LINE__, "unexpected exception: " + e);
+  }
+  return parameter_test::failures();
+}